@@ -0,0 +1,6 @@
+#!/bin/bash
+sources="entity-lookups.cpp"
+includes="-I../lib/cul/inc -I../inc"
+defaultflags="-std=c++17 -O3 -DNDEBUG -Wall -pedantic-errors -DMACRO_PLATFORM_LINUX -fexceptions"
+g++ $defaultflags $sources $includes -o .entity-lookups
+./.entity-lookups
@@ -0,0 +1,131 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+/// @file entity-lookups.cpp
+/// Compares the time taken to add and to look up components, for each entity
+/// type, on entities with 1 to 64 components.
+
+#include <ariajanke/ecs3/ecs.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ecs::Size;
+
+static constexpr const Size k_entity_count = 1024;
+static constexpr const int k_lookup_passes = 64;
+
+template <int k_n>
+struct Component final { std::uint32_t value = k_n; };
+
+struct Timings final {
+    double add_ns = 0.;
+    double lookup_ns = 0.;
+};
+
+double nanoseconds_per(Clock::duration dur, Size count) {
+    using namespace std::chrono;
+    return double(duration_cast<nanoseconds>(dur).count()) / double(count);
+}
+
+template <typename EntityType, int ... kt_ns>
+Timings time_entity_type(std::integer_sequence<int, kt_ns...>) {
+    static constexpr const Size k_component_count = sizeof...(kt_ns);
+    std::vector<EntityType> entities;
+    entities.reserve(k_entity_count);
+    for (Size i = 0; i != k_entity_count; ++i)
+        { entities.emplace_back(EntityType::make_sceneless_entity()); }
+
+    Timings rv;
+    auto start = Clock::now();
+    for (auto & entity : entities)
+        { (entity.template add<Component<kt_ns>>(), ...); }
+    rv.add_ns = nanoseconds_per
+        (Clock::now() - start, k_entity_count*k_component_count);
+
+    // volatile, so that the lookups are not optimized away
+    volatile std::uint32_t sink = 0;
+    start = Clock::now();
+    for (int pass = 0; pass != k_lookup_passes; ++pass) {
+        std::uint32_t sum = 0;
+        for (auto & entity : entities)
+            { sum += (entity.template get<Component<kt_ns>>().value + ...); }
+        sink = sink + sum;
+    }
+    rv.lookup_ns = nanoseconds_per
+        (Clock::now() - start, k_lookup_passes*k_entity_count*k_component_count);
+    return rv;
+}
+
+template <int k_component_count>
+void print_row() {
+    using Seq = std::make_integer_sequence<int, k_component_count>;
+    auto hash   = time_entity_type<ecs::HashTableEntity   >(Seq{});
+    auto avl    = time_entity_type<ecs::AvlTreeEntity     >(Seq{});
+    auto sorted = time_entity_type<ecs::SortedVectorEntity>(Seq{});
+    auto adapt  = time_entity_type<ecs::AdaptiveEntity    >(Seq{});
+    auto print = [] (const Timings & timings) {
+        std::cout << std::setw(10) << timings.add_ns
+                  << std::setw(10) << timings.lookup_ns;
+    };
+    std::cout << std::setw(6) << k_component_count;
+    print(hash);
+    print(avl);
+    print(sorted);
+    print(adapt);
+    std::cout << std::endl;
+}
+
+} // end of <anonymous> namespace
+
+int main() {
+    std::cout << std::fixed << std::setprecision(2)
+              << "nanoseconds per component, for " << k_entity_count
+              << " entities\n"
+              << std::setw(6)  << "count"
+              << std::setw(20) << "HashTableEntity"
+              << std::setw(20) << "AvlTreeEntity"
+              << std::setw(20) << "SortedVectorEntity"
+              << std::setw(20) << "AdaptiveEntity" << "\n"
+              << std::setw(6)  << "";
+    for (int i = 0; i != 4; ++i)
+        { std::cout << std::setw(10) << "add" << std::setw(10) << "lookup"; }
+    std::cout << std::endl;
+    print_row<1>();
+    print_row<2>();
+    print_row<4>();
+    print_row<8>();
+    print_row<16>();
+    print_row<32>();
+    print_row<64>();
+    return 0;
+}
@@ -0,0 +1,349 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/entity-common.hpp>
+#include <ariajanke/ecs3/detail/AdaptiveEntity.hpp>
+
+namespace ecs {
+
+class ConstAdaptiveEntity;
+
+/// An entity which picks how to keep its components for itself, by how many
+/// it has: a sorted array while few, and a hash table once many.
+///
+/// So one scene may hold both tiny entities (like particles) and large ones
+/// (like actors with dozens of components), each kept in the layout that
+/// suits it.
+///
+/// @note Components are moved when the entity changes layout, just as they
+///       are when any entity's storage grows.
+class AdaptiveEntity final : public EntityBase<AdaptiveEntity> {
+public:
+    using HomeScene   = HomeSceneBase<AdaptiveEntity>;
+    using ConstEntity = ConstAdaptiveEntity;
+
+    AdaptiveEntity() {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit AdaptiveEntity(const EntityRef & ref):
+        m_body(ref.get_body<AdaptiveEntityBody>(AdaptiveEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit AdaptiveEntity(EntityRef && ref):
+        m_body(ref.get_body<AdaptiveEntityBody>(AdaptiveEntityBody::get_safety()))
+    {}
+
+    AdaptiveEntity(const AdaptiveEntity &) = default;
+
+    AdaptiveEntity(AdaptiveEntity &&) = default;
+
+    static AdaptiveEntity make_sceneless_entity()
+        { return AdaptiveEntity{SharedPtr<AdaptiveEntityBody>::make()}; }
+
+    AdaptiveEntity & operator = (const AdaptiveEntity &) = default;
+
+    AdaptiveEntity & operator = (AdaptiveEntity &&) = default;
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const AdaptiveEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const AdaptiveEntity & rhs) const { return m_body != rhs.m_body; }
+
+    AdaptiveEntity make_entity() const {
+        AdaptiveEntity rv{SharedPtr<AdaptiveEntityBody>::make(*m_body)};
+        rv.reserve_capacity_(rv.m_body->capacity_hint());
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, in the same scene as this one, with a copy of
+    ///          each of this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    AdaptiveEntity clone() const {
+        AdaptiveEntity rv{SharedPtr<AdaptiveEntityBody>::make(*m_body)};
+        rv.m_body->copy_from(*m_body);
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, belonging to no scene, with a copy of each of
+    ///          this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    AdaptiveEntity clone_sceneless() const {
+        auto rv = make_sceneless_entity();
+        rv.m_body->copy_from(*m_body);
+        return rv;
+    }
+
+    ConstAdaptiveEntity as_constant() const;
+
+    /// Requested that the refered entity be deleted by the owning manager
+    /// object. Entities cannot delete themselves.
+    void request_deletion()
+        { m_body->on_deletion_request(*this); }
+
+    /// Swaps components between two entities.
+    void swap(AdaptiveEntity & rhs) { std::swap(m_body, rhs.m_body); }
+
+    /// @note hash code cannnot be guaranteed to be unique if the code outlives
+    ///       it's original entity
+    /// @returns a unique hash code that identifies this entity
+    Size hash() const noexcept
+        { return m_body.owner_hash(); }
+
+    /// @returns the id this entity was given when created, zero if this is a
+    ///          null entity
+    EntityId id() const noexcept
+        { return m_body ? m_body->id() : EntityId(0); }
+
+    void remove_all() {
+        m_body->remove_all();
+        log_components_change_(ComponentChange::removed_all, TypeList<>{});
+    }
+
+    /// @returns true if components are kept in a hash table, rather than a
+    ///          sorted array
+    bool uses_hash_table() const noexcept { return m_body->uses_table(); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets the home scene component.
+    void set_home_scene(HomeScene & home_scene)
+        { m_body->set_home(home_scene); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets where the home scene keeps this entity.
+    void set_scene_index(Size idx) noexcept
+        { m_body->set_scene_index(idx); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// @returns where the home scene keeps this entity
+    Size scene_index() const noexcept
+        { return m_body->scene_index(); }
+
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+private:
+    friend class EntityBase<AdaptiveEntity>;
+    friend class ConstEntityBase<AdaptiveEntity>;
+
+    explicit AdaptiveEntity(SharedPtr<AdaptiveEntityBody> && body_ptr):
+        m_body(std::move(body_ptr)) {}
+
+    template <typename ... ChangedTypes>
+    void log_components_change_
+        (ComponentChange change, TypeList<ChangedTypes...> types) const
+        { m_body->log_components_change(*this, change, types); }
+
+    template <typename T, typename ... ArgTypes>
+    T & add_with_args_(ArgTypes &&... args);
+
+    template <typename ... Types>
+    Tuple<Types & ...> add_(TypeList<Types...>);
+
+    template <typename ... Types>
+    Tuple<Types & ...> add_blueprint_(const EntityBlueprint<Types...> &);
+
+    template <typename T>
+    T * ptr_() { return m_body->get<T>(); }
+
+    template <typename T>
+    const T * cptr_() const { return m_body->get<T>(); }
+
+    template <typename ... Types>
+    void remove_(TypeList<Types...>) {
+        remove_without_adapting(TypeList<Types...>{});
+        m_body->adapt_to(m_body->count());
+    }
+
+    template <typename ... Removes, typename ... Adds>
+    void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>);
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->generation(); }
+
+    void reserve_capacity_(const CapacityHint &);
+
+    CapacityHint capacity_used_() const noexcept
+        { return m_body->capacity_used(); }
+
+    auto as_weak_ptr_() const noexcept
+        { return WeakPtr<EntityBodyBase>{m_body}; }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    template <typename ... Types>
+    void remove_without_adapting(TypeList<Types...>);
+
+    // reserves, in whichever layout is in use, so that appending each type
+    // moves nothing
+    template <typename ... Types>
+    void reserve_for_more(TypeList<Types...>);
+
+    SharedPtr<AdaptiveEntityBody> m_body;
+#   endif
+};
+
+class ConstAdaptiveEntity final : public ConstEntityBase<ConstAdaptiveEntity> {
+public:
+    ConstAdaptiveEntity() {}
+
+    explicit ConstAdaptiveEntity(const SharedPtr<const AdaptiveEntityBody> & body_ptr):
+        m_body(body_ptr) {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstAdaptiveEntity(const EntityRef & ref):
+        m_body(ref.get_body<const AdaptiveEntityBody>(AdaptiveEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstAdaptiveEntity(EntityRef && ref):
+        m_body(ref.get_body<const AdaptiveEntityBody>(AdaptiveEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstAdaptiveEntity(const ConstEntityRef & ref):
+        m_body(ref.get_body<const AdaptiveEntityBody>(AdaptiveEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstAdaptiveEntity(ConstEntityRef && ref):
+        m_body(ref.get_body<const AdaptiveEntityBody>(AdaptiveEntityBody::get_safety()))
+    {}
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const ConstAdaptiveEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const ConstAdaptiveEntity & rhs) const { return m_body != rhs.m_body; }
+
+private:
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+    friend class ConstEntityBase<ConstAdaptiveEntity>;
+
+    template <typename T>
+    const T * cptr_() const { return m_body->get<T>(); }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->generation(); }
+
+    SharedPtr<const AdaptiveEntityBody> m_body;
+#   endif
+};
+
+// ------------------------------- INTERFACE END ------------------------------
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+inline ConstAdaptiveEntity AdaptiveEntity::as_constant() const
+    { return ConstAdaptiveEntity{m_body}; }
+
+template <typename T, typename ... ArgTypes>
+/* private */ T & AdaptiveEntity::add_with_args_(ArgTypes &&... args) {
+    auto & body = *m_body;
+    body.grow_to(body.count() + 1);
+    if (body.uses_table())
+        { return body.table.append<T>(std::forward<ArgTypes>(args)...); }
+    return body.array.append<T>(std::forward<ArgTypes>(args)...);
+}
+
+template <typename ... Types>
+/* private */ Tuple<Types & ...> AdaptiveEntity::add_(TypeList<Types...>) {
+    auto & body = *m_body;
+    body.grow_to(body.count() + sizeof...(Types));
+    // one reservation, so that no reference handed back is moved by a later
+    // append
+    reserve_for_more(TypeList<Types...>{});
+    if (body.uses_table())
+        { return Tuple<Types & ...>{body.table.append<Types>()...}; }
+    return Tuple<Types & ...>{body.array.append<Types>()...};
+}
+
+template <typename ... Types>
+/* private */ Tuple<Types & ...> AdaptiveEntity::add_blueprint_
+    (const EntityBlueprint<Types...> & blueprint)
+{
+    auto & body = *m_body;
+    if (body.count() != 0) return add_(TypeList<Types...>{});
+    body.adapt_to(sizeof...(Types));
+    if (body.uses_table()) return body.table.emplace_blueprint(blueprint);
+    return add_(TypeList<Types...>{});
+}
+
+template <typename ... Removes, typename ... Adds>
+/* private */ void AdaptiveEntity::prepare_edit_
+    (TypeList<Removes...>, TypeList<Adds...>)
+{
+    // layout is settled once, for the count that the edit leaves
+    remove_without_adapting(TypeList<Removes...>{});
+    m_body->adapt_to(m_body->count() + sizeof...(Adds));
+    reserve_for_more(TypeList<Adds...>{});
+}
+
+/* private */ inline void AdaptiveEntity::reserve_capacity_
+    (const CapacityHint & hint)
+{
+    auto & body = *m_body;
+    body.adapt_to(std::max(body.count(), hint.component_count));
+    if (body.uses_table()) body.table.reserve(hint);
+    else body.array.reserve(hint);
+}
+
+template <typename ... Types>
+/* private */ void AdaptiveEntity::remove_without_adapting(TypeList<Types...>) {
+    auto & body = *m_body;
+    if (body.uses_table()) ((void)body.table.remove<Types>(), ...);
+    else ((void)body.array.remove<Types>(), ...);
+}
+
+template <typename ... Types>
+/* private */ void AdaptiveEntity::reserve_for_more(TypeList<Types...> tl) {
+    if constexpr (sizeof...(Types) != 0) {
+        if (m_body->uses_table()) m_body->table.reserve_for_more(tl);
+        else m_body->array.reserve_for_more(tl);
+    }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+} // end of ecs namespace
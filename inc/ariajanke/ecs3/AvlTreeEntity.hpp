@@ -71,6 +71,46 @@ public:
 
     AvlTreeEntity make_entity() const;
 
+    /// @returns a new entity, in the same scene as this one, with a copy of
+    ///          each of this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    AvlTreeEntity clone() const;
+
+    /// @returns a new entity, belonging to no scene, with a copy of each of
+    ///          this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    AvlTreeEntity clone_sceneless() const;
+
+    /// Takes a snapshot of this entity, in constant time, by sharing its
+    /// components rather than copying them. Changes to either entity, after
+    /// this call, copy only the shared components they must (those on the
+    /// way to what's changed).
+    ///
+    /// @note Components which are not copyable may still be shared, but then
+    ///       changes near them will throw.
+    /// @note Share counts, and the flags marking nodes as shared, are not
+    ///       atomic; changing either entity writes them. So a snapshot, and
+    ///       its original, must only be used from one thread at a time.
+    /// @note A frozen entity's components are copied instead.
+    /// @returns a new entity, belonging to no scene, which sees this
+    ///          entity's components as they are now
+    AvlTreeEntity snapshot() const;
+
+    /// Moves every component out of the tree, and into a compact, read only
+    /// layout: a single allocation, with keys sorted, and searched without
+    /// branches. Meant for entities that are done being built, and are only
+    /// looked at from then on.
+    ///
+    /// Adding or removing components thaws the entity first, moving its
+    /// components back into a tree.
+    ///
+    /// @throws std::runtime_error if a component shared with a snapshot is
+    ///         not copyable
+    void freeze() { m_body->freeze(); }
+
+    /// @returns true if components are in the frozen layout
+    bool is_frozen() const noexcept { return m_body->is_frozen(); }
+
     ConstAvlTreeEntity as_constant() const;
 
     /// Requested that the refered entity be deleted by the owning manager
@@ -87,11 +127,26 @@ public:
     Size hash() const noexcept
         { return m_body.owner_hash(); }
 
+    /// @returns the id this entity was given when created, zero if this is a
+    ///          null entity
+    EntityId id() const noexcept
+        { return m_body ? m_body->id() : EntityId(0); }
+
     /// <strong>Not intended for client use.</strong>
     /// This method sets the home scene component.
     void set_home_scene(HomeScene & home_scene)
         { m_body->set_home(home_scene); }
 
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets where the home scene keeps this entity.
+    void set_scene_index(Size idx) noexcept
+        { m_body->set_scene_index(idx); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// @returns where the home scene keeps this entity
+    Size scene_index() const noexcept
+        { return m_body->scene_index(); }
+
 #   ifndef DOXYGEN_SHOULD_SKIP_THIS
 private:
     friend class EntityBase<AvlTreeEntity>;
@@ -100,6 +155,11 @@ private:
     AvlTreeEntity(SharedPtr<AvlTreeEntityBody> && body_ptr):
         m_body(std::move(body_ptr)) {}
 
+    template <typename ... ChangedTypes>
+    void log_components_change_
+        (ComponentChange change, TypeList<ChangedTypes...> types) const
+        { m_body->log_components_change(*this, change, types); }
+
     template <typename ... Types>
     static Tuple<Types & ...> tuple_from_multinode
         (NodeOwningPtr * beg, NodeOwningPtr * end, TypeList<Types...>);
@@ -112,26 +172,65 @@ private:
     template <typename T, typename ... ArgTypes>
     T & add_with_args_(ArgTypes &&... args);
 
+    // reuses a vacated node for the new component if there is one, otherwise
+    // makes a new one
+    template <typename T, typename ... ArgTypes>
+    NodeOwningPtr take_vacated_(ArgTypes &&... args);
+
     bool has_expired_() const noexcept { return m_body.owners() > 0; }
 
     template <typename ... Types>
     void remove_(TypeList<Types...>) { /* should be noexcept */ }
 
+    // lets go of any vacated node made together with the given one, so that
+    // their block is freed once none of its components are left
+    void release_vacated_beside_(const NodeInstance & node);
+
+    // @returns key of a node made together with the given one, or zero if
+    //          there are none in the tree
+    static Size key_beside_(const NodeInstance * root, const NodeInstance & node) noexcept;
+
     template <typename Head, typename ... Types>
     void remove_(TypeList<Head, Types...>);
 
+    // nodes are allocated as components are added, there's nothing to get
+    // ready ahead of time
+    template <typename ... Removes, typename ... Adds>
+    void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>) {
+        m_body->thaw();
+        remove_(TypeList<Removes...>{});
+    }
+
     template <typename Type>
-    Type * ptr_() noexcept
-        { return m_body->root ? const_cast<Type *>(cptr_<Type>()) : nullptr; }
+    Type * ptr_()
+        { return reinterpret_cast<Type *>(m_body->find_private(MetaFunctions::key_for_type<Type>())); }
+
+    // copies shared nodes that a change, at the given key, may touch
+    void unshare_for_change_(Size key);
 
     template <typename ... Types>
     Tuple<Types & ...> add_(TypeList<Types...>);
 
+    // a multinode already places every component in one allocation
+    template <typename ... Types>
+    Tuple<Types & ...> add_blueprint_(const EntityBlueprint<Types...> &)
+        { return add_(TypeList<Types...>{}); }
+
     template <typename Type>
     const Type * cptr_() const noexcept;
 
     bool is_null_() const noexcept { return !m_body; }
 
+    Size storage_generation_() const noexcept
+        { return m_body->storage_generation; }
+
+    // nodes are allocated one (or one group) at a time, there's no space to
+    // set aside ahead of time
+    void reserve_capacity_(const CapacityHint &) {}
+
+    CapacityHint capacity_used_() const noexcept
+        { return CapacityHint{}; }
+
     auto as_weak_cptr_() const noexcept
         { return WeakPtr<const EntityBodyBase>{m_body}; }
 
@@ -186,16 +285,17 @@ private:
     // I do not want double implementation!
 
     template <typename T>
-    const T * cptr_() const {
-        if (!m_body->root) return nullptr;
-        return reinterpret_cast<T *>(m_body->root->ptr<StorageFor<T>>());
-    }
+    const T * cptr_() const
+        { return reinterpret_cast<const T *>(m_body->find(MetaFunctions::key_for_type<T>())); }
 
     auto as_weak_cptr_() const noexcept
         { return WeakPtr<const EntityBodyBase>{m_body}; }
 
     bool is_null_() const noexcept { return !m_body; }
 
+    Size storage_generation_() const noexcept
+        { return m_body->storage_generation; }
+
     SharedPtr<const AvlTreeEntityBody> m_body;
 #   endif
 };
@@ -214,6 +314,33 @@ inline AvlTreeEntity AvlTreeEntity::make_entity() const {
     return rv;
 }
 
+inline AvlTreeEntity AvlTreeEntity::clone() const {
+    auto rv = AvlTreeEntity{SharedPtr<AvlTreeEntityBody>::make(*m_body)};
+    rv.m_body->root = NodeInstance::copy_tree(m_body->root.get());
+    rv.m_body->frozen.copy_from(m_body->frozen);
+    rv.m_body->on_create(rv);
+    return rv;
+}
+
+inline AvlTreeEntity AvlTreeEntity::snapshot() const {
+    auto rv = make_sceneless_entity();
+    rv.m_body->root = NodeInstance::share(m_body->root);
+    // a frozen layout is not shared, but copied
+    rv.m_body->frozen.copy_from(m_body->frozen);
+    rv.m_body->may_share = m_body->may_share = true;
+    // anything remembered is now shared, including what handles hold
+    m_body->lookup_cache.clear();
+    ++m_body->storage_generation;
+    return rv;
+}
+
+inline AvlTreeEntity AvlTreeEntity::clone_sceneless() const {
+    auto rv = make_sceneless_entity();
+    rv.m_body->root = NodeInstance::copy_tree(m_body->root.get());
+    rv.m_body->frozen.copy_from(m_body->frozen);
+    return rv;
+}
+
 template <typename ... Types>
 /* private static */ Tuple<Types & ...> AvlTreeEntity::tuple_from_multinode
     (NodeOwningPtr * beg, NodeOwningPtr * end, TypeList<Types...>)
@@ -237,7 +364,9 @@ template <typename Head, typename ... Types>
 template <typename T, typename ... ArgTypes>
 /* private */ T & AvlTreeEntity::add_with_args_(ArgTypes &&... args) {
     using std::move;
-    auto node = make_single_type_node<T>(std::forward<ArgTypes>(args)...);
+    m_body->thaw();
+    unshare_for_change_(MetaFunctions::key_for_type<T>());
+    auto node = take_vacated_<T>(std::forward<ArgTypes>(args)...);
     auto & rv = *node->template ptr<T>();
     auto res = NodeInstance::avl_insert(move(m_body->root), move(node));
     if (res.given) {
@@ -247,41 +376,114 @@ template <typename T, typename ... ArgTypes>
     return rv;
 }
 
+template <typename T, typename ... ArgTypes>
+/* private */ NodeOwningPtr AvlTreeEntity::take_vacated_(ArgTypes &&... args) {
+    using std::move;
+    if (!m_body->vacated)
+        { return make_single_type_node<T>(std::forward<ArgTypes>(args)...); }
+    auto [vacated, node] = NodeInstance::avl_remove
+        (move(m_body->vacated), MetaFunctions::key_for_type<T>()); {}
+    m_body->vacated = move(vacated);
+    if (!node)
+        { return make_single_type_node<T>(std::forward<ArgTypes>(args)...); }
+    try {
+        new (node->datum()) T(std::forward<ArgTypes>(args)...);
+    } catch (...) {
+        m_body->vacated = NodeInstance::avl_insert
+            (move(m_body->vacated), move(node)).root;
+        throw;
+    }
+    node->revive();
+    return move(node);
+}
+
 template <typename Head, typename ... Types>
 /* private */ void AvlTreeEntity::remove_(TypeList<Head, Types...>) {
+    m_body->thaw();
     assert(m_body->root);
     auto key = MetaFunctions::key_for_type<Head>();
+    unshare_for_change_(key);
     auto [root, removed] = NodeInstance::avl_remove(move(m_body->root), key); {}
     assert(removed);
-    // removed's destructor handles destructing of the datum, as it should
     m_body->root = move(root);
+    m_body->lookup_cache.forget(key);
+    ++m_body->storage_generation;
+    // removed's destructor handles destructing of the datum, as it should,
+    // unless its space may be kept for another of its type
+    if (removed->vacate()) {
+        // an already vacated node of this type is fine to let go
+        m_body->vacated = NodeInstance::avl_insert
+            (move(m_body->vacated), move(removed)).root;
+    } else if (m_body->vacated) {
+        release_vacated_beside_(*removed);
+    }
     remove_(TypeList<Types...>{});
 }
 
+/* private */ inline void AvlTreeEntity::release_vacated_beside_
+    (const NodeInstance & node)
+{
+    using std::move;
+    // there are few, so each is sought on its own; and a lone node has none
+    // to seek at all
+    while (node.source_keeps_vacated()) {
+        auto key = key_beside_(m_body->vacated.get(), node);
+        // (the rest may be vacated in a snapshot's tree)
+        if (!key) return;
+        m_body->vacated = NodeInstance::avl_remove
+            (move(m_body->vacated), key).root;
+    }
+}
+
+/* private static */ inline Size AvlTreeEntity::key_beside_
+    (const NodeInstance * root, const NodeInstance & node) noexcept
+{
+    if (!root) return 0;
+    if (root->shares_source_with(node)) return root->key();
+    if (auto key = key_beside_(root->left(), node)) return key;
+    return key_beside_(root->right(), node);
+}
+
 template <typename ... Types>
 /* private */ Tuple<Types & ...> AvlTreeEntity::add_(TypeList<Types...>) {
     using std::move;
+    // a lone component may take a vacated node
+    if constexpr (sizeof...(Types) == 1)
+        { return std::tie(add_with_args_<Types...>()); }
+    m_body->thaw();
     auto newnodes = make_multiple_type_nodes<Types...>();
-    auto insert = [](NodeOwningPtr root, NodeOwningPtr newnode) {
-        auto [nroot_, reject] = NodeInstance::avl_insert(move(root), move(newnode)); {}
-        assert(!reject);
-        return move(nroot_);
-    };
     auto rv = tuple_from_multinode(&newnodes[0], &newnodes[0] + sizeof...(Types),
         TypeList<Types...>{});
-    for (auto & node : newnodes) {
-        m_body->root = insert(move(m_body->root), move(node));
+    if (m_body->may_share) {
+        // only paths the new nodes touch are copied, all before the tree is
+        // changed; an insert only moves nodes already copied for its own key,
+        // so no later insert finds anything else shared on its way
+        for (auto & node : newnodes)
+            { unshare_for_change_(node->key()); }
+        for (auto & node : newnodes) {
+            auto res = NodeInstance::avl_insert(move(m_body->root), move(node));
+            assert(!res.given);
+            m_body->root = move(res.root);
+        }
+        return rv;
     }
+    std::sort(newnodes.begin(), newnodes.end(),
+        [] (const NodeOwningPtr & lhs, const NodeOwningPtr & rhs)
+        { return lhs->key() < rhs->key(); });
+    m_body->root = NodeInstance::join_sorted
+        (move(m_body->root), newnodes.data(), newnodes.data() + newnodes.size());
     return rv;
 }
 
-template <typename Type>
-/* private */ const Type * AvlTreeEntity::cptr_() const noexcept {
-    if (!m_body->root) return nullptr;
-    // this isn't right...
-    return reinterpret_cast<const Type *>(m_body->root->ptr<StorageFor<Type>>());
+/* private */ inline void AvlTreeEntity::unshare_for_change_(Size key) {
+    if (m_body->may_share && NodeInstance::unshare_for_change(m_body->root, key))
+        { ++m_body->storage_generation; }
 }
 
+template <typename Type>
+/* private */ const Type * AvlTreeEntity::cptr_() const noexcept
+    { return reinterpret_cast<const Type *>(m_body->find(MetaFunctions::key_for_type<Type>())); }
+
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
 } // end of ecs namespace
@@ -0,0 +1,243 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/SingleSystem.hpp>
+#include <ariajanke/ecs3/detail/BatchSystem.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace ecs {
+
+/// A run of contiguous objects, which is how batch kernels receive
+/// components.
+template <typename T>
+class Span final {
+public:
+    Span() {}
+
+    Span(T * beg, Size count): m_begin(beg), m_count(count) {}
+
+    T * begin() const noexcept { return m_begin; }
+
+    T * end() const noexcept { return m_begin + m_count; }
+
+    T * data() const noexcept { return m_begin; }
+
+    Size size() const noexcept { return m_count; }
+
+    bool empty() const noexcept { return m_count == 0; }
+
+    T & operator [] (Size idx) const noexcept { return m_begin[idx]; }
+
+private:
+    T * m_begin = nullptr;
+    Size m_count = 0;
+};
+
+/// A system whose kernel is called once per batch of entities, rather than
+/// once per entity. The kernel takes a span for each component type, e.g.
+/// void(Span<Position>, Span<const Velocity>), where the nth element of
+/// every span belongs to the same entity.
+///
+/// Components live with their entities, so each batch is copied into
+/// contiguous buffers before the kernel is called, and components of
+/// non-const spans are written back to their entities after. This gives
+/// kernels plain arrays to loop over, which compilers may vectorize.
+///
+/// If the kernel (or copying a component) throws, the batch being built is
+/// dropped, and components of that batch keep the values they had before.
+///
+/// @note a batch system reuses its buffers from one run to the next, and
+///       so must not run on more than one thread at a time
+template <typename EntityType, typename Kernel, typename ... Types>
+class BatchSystem final : public SingleSystemBase<EntityType> {
+public:
+    /// Most entities handed to the kernel at once
+    static constexpr const Size k_batch_size = 256;
+
+    explicit BatchSystem(Kernel kernel): m_kernel(std::move(kernel)) {}
+
+    /// Same as calling the system on the scene, without any virtual call
+    void run_on(const SceneOf<EntityType> & scene) const;
+
+    // ----------------------------- INTERFACE END ----------------------------
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+protected:
+    void operate(EntityType & ent) const final;
+
+    void operate_on_scene(const SceneOf<EntityType> & scene) const final
+        { run_on(scene); }
+
+private:
+    template <typename T>
+    using ComponentOf = std::remove_const_t<T>;
+
+    static_assert((std::is_copy_constructible_v<ComponentOf<Types>> && ...),
+                  "components handed to batch kernels must be copyable");
+
+    using PointerTuple = Tuple<ComponentOf<Types> *...>;
+
+    using IndexSequence = std::index_sequence_for<Types...>;
+
+    void gather(EntityType & ent) const;
+
+    template <Size ... kt_indices>
+    void gather(const PointerTuple &, std::index_sequence<kt_indices...>) const;
+
+    void flush() const;
+
+    template <Size ... kt_indices>
+    void flush(std::index_sequence<kt_indices...>) const;
+
+    template <Size kt_index>
+    void write_back() const;
+
+    void clear() const noexcept;
+
+    Kernel m_kernel;
+    mutable std::vector<PointerTuple> m_sources;
+    mutable Tuple<std::vector<ComponentOf<Types>>...> m_buffers;
+#   endif // DOXYGEN_SHOULD_SKIP_THIS
+};
+
+template <typename EntityType, typename Kernel>
+using BatchSystemFromKernel =
+    typename BatchSystemFromKernel_<EntityType, Kernel>::Type;
+
+template <typename EntityType, typename Kernel>
+auto make_batch_system(Kernel && kernel) {
+    return BatchSystemFromKernel<EntityType, std::decay_t<Kernel>>
+        {std::forward<Kernel>(kernel)};
+}
+
+template <typename EntityType, typename Kernel>
+auto make_batch_system_uptr(Kernel && kernel) {
+    return std::make_unique<BatchSystemFromKernel<EntityType, std::decay_t<Kernel>>>
+        (std::forward<Kernel>(kernel));
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename EntityType, typename Kernel, typename ... Types>
+void BatchSystem<EntityType, Kernel, Types...>::run_on
+    (const SceneOf<EntityType> & scene) const
+{
+    try {
+        for (auto ent : scene.template candidates_having<ComponentOf<Types>...>())
+            { gather(ent); }
+        flush();
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+/* protected */ void BatchSystem<EntityType, Kernel, Types...>::operate
+    (EntityType & ent) const
+{
+    try {
+        gather(ent);
+        flush();
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+/* private */ void BatchSystem<EntityType, Kernel, Types...>::gather
+    (EntityType & ent) const
+{
+    PointerTuple sources{ent.template ptr<ComponentOf<Types>>()...};
+    bool has_every = std::apply([] (ComponentOf<Types> * ... ptrs)
+        { return (ptrs && ...); }, sources);
+    if (!has_every) return;
+    gather(sources, IndexSequence{});
+    if (m_sources.size() == k_batch_size) flush();
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+template <Size ... kt_indices>
+/* private */ void BatchSystem<EntityType, Kernel, Types...>::gather
+    (const PointerTuple & sources, std::index_sequence<kt_indices...>) const
+{
+    // sources go in last, so a throw never leaves them longer than a buffer
+    Size pushed = 0;
+    try {
+        ((std::get<kt_indices>(m_buffers).push_back(*std::get<kt_indices>(sources)),
+          ++pushed), ...);
+        m_sources.push_back(sources);
+    } catch (...) {
+        ((kt_indices < pushed ? std::get<kt_indices>(m_buffers).pop_back() : void()), ...);
+        throw;
+    }
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+/* private */ void BatchSystem<EntityType, Kernel, Types...>::flush() const {
+    if (m_sources.empty()) return;
+    try {
+        flush(IndexSequence{});
+    } catch (...) {
+        clear();
+        throw;
+    }
+    clear();
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+template <Size ... kt_indices>
+/* private */ void BatchSystem<EntityType, Kernel, Types...>::flush
+    (std::index_sequence<kt_indices...>) const
+{
+    m_kernel(Span<Types>{std::get<kt_indices>(m_buffers).data(), m_sources.size()}...);
+    (write_back<kt_indices>(), ...);
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+template <Size kt_index>
+/* private */ void BatchSystem<EntityType, Kernel, Types...>::write_back() const {
+    using Type = std::tuple_element_t<kt_index, Tuple<Types...>>;
+    if constexpr (!std::is_const_v<Type>) {
+        auto & buffer = std::get<kt_index>(m_buffers);
+        for (Size i = 0; i != m_sources.size(); ++i)
+            { *std::get<kt_index>(m_sources[i]) = std::move(buffer[i]); }
+    }
+}
+
+template <typename EntityType, typename Kernel, typename ... Types>
+/* private */ void BatchSystem<EntityType, Kernel, Types...>::clear() const noexcept {
+    m_sources.clear();
+    std::apply([] (auto & ... buffers) { (buffers.clear(), ...); }, m_buffers);
+}
+
+} // end of ecs namespace
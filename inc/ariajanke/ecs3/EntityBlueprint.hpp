@@ -0,0 +1,142 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+#pragma once
+
+#include <ariajanke/ecs3/defs.hpp>
+
+#include <array>
+#include <algorithm>
+
+namespace ecs {
+
+template <typename ... Types>
+struct BlueprintLayout;
+
+/// Describes a fixed set of component types, with their layout worked out
+/// ahead of time.
+///
+/// The offset of every component, and the total number of bytes for the
+/// whole set are computed at compile time. Entity types may use a blueprint
+/// to give an entity all of its components at once, without having to work
+/// out where each one goes.
+///
+/// Components are placed by alignment (largest first), so that no space is
+/// lost to padding between them.
+template <typename ... Types>
+class EntityBlueprint final {
+public:
+    using ComponentTypes = TypeList<Types...>;
+
+    /// number of components in the blueprint
+    static constexpr const Size k_count = sizeof...(Types);
+
+    /// alignment needed for the whole set
+    static constexpr const Size k_alignment = BlueprintLayout<Types...>::k_alignment;
+
+    /// bytes needed for the whole set
+    static constexpr const Size k_component_bytes = BlueprintLayout<Types...>::k_bytes;
+
+    /// offset in bytes of each component (in the order given) from the
+    /// start of the set
+    static constexpr const std::array<Size, k_count> k_offsets =
+        BlueprintLayout<Types...>::k_offsets;
+
+    /// @returns the offset in bytes of the given component type
+    template <typename T>
+    static constexpr Size offset_of() noexcept
+        { return k_offsets[BlueprintLayout<Types...>::template index_of<T>()]; }
+};
+
+// ------------------------------ INTERFACE END -------------------------------
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <typename ... Types>
+struct BlueprintLayout final {
+    template <typename T, typename ... Others>
+    static constexpr int k_count_of = (int(std::is_same_v<T, Others>) + ... + 0);
+
+    static_assert(((k_count_of<Types, Types...> == 1) && ...),
+                  "Each component type may only appear once in a blueprint.");
+    static_assert(((alignof(Types) <= alignof(std::max_align_t)) && ...),
+                  "Over aligned component types are not supported by blueprints.");
+
+    static constexpr const Size k_count = sizeof...(Types);
+
+    static constexpr const Size k_alignment = std::max({Size(1), alignof(Types)...});
+
+    template <typename T>
+    static constexpr Size index_of() noexcept {
+        static_assert(k_count_of<T, Types...> == 1,
+                      "Type is not part of this blueprint.");
+        Size idx = 0;
+        (void)((!std::is_same_v<T, Types> && ++idx) && ...);
+        return idx;
+    }
+
+    static constexpr std::array<Size, k_count> compute_offsets() noexcept {
+        std::array<Size, k_count> sizes  = { sizeof (Types)... };
+        std::array<Size, k_count> aligns = { alignof(Types)... };
+        std::array<Size, k_count> order  = {};
+        for (Size i = 0; i != k_count; ++i) order[i] = i;
+        // stable, largest alignment first
+        for (Size i = 1; i < k_count; ++i) {
+            for (Size j = i; j > 0 && aligns[order[j - 1]] < aligns[order[j]]; --j) {
+                auto t = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = t;
+            }
+        }
+        std::array<Size, k_count> rv = {};
+        Size offset = 0;
+        for (Size i = 0; i != k_count; ++i) {
+            offset = round_up(offset, aligns[order[i]]);
+            rv[order[i]] = offset;
+            offset += sizes[order[i]];
+        }
+        return rv;
+    }
+
+    static constexpr Size compute_bytes() noexcept {
+        std::array<Size, k_count> sizes = { sizeof(Types)... };
+        Size rv = 0;
+        for (Size i = 0; i != k_count; ++i)
+            { rv = std::max(rv, k_offsets[i] + sizes[i]); }
+        return round_up(rv, k_alignment);
+    }
+
+    static constexpr Size round_up(Size value, Size align) noexcept
+        { return ((value + align - 1) / align)*align; }
+
+    static constexpr const std::array<Size, k_count> k_offsets = compute_offsets();
+
+    static constexpr const Size k_bytes = compute_bytes();
+};
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+} // end of ecs namespace
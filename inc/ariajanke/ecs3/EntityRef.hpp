@@ -153,6 +153,8 @@ class EntityBodyIntr : public EntityBodyBase {
 public:
     using HomeScene = HomeSceneBase<EntityType>;
 
+    static constexpr const Size k_no_scene_index = Size(-1);
+
     EntityBodyIntr() {}
 
     EntityBodyIntr(const EntityBodyIntr & body):
@@ -167,6 +169,20 @@ public:
 
     void on_deletion_request(const EntityType &) const;
 
+    template <typename ... Types>
+    void log_components_change
+        (const EntityType & entity, ComponentChange change, TypeList<Types...> types) const
+    { m_home->log_components_change(entity, change, types); }
+
+    CapacityHint capacity_hint() const { return m_home->capacity_hint(); }
+
+    /// @returns where the home scene keeps this entity, k_no_scene_index if
+    ///          it is not (yet) kept by any
+    Size scene_index() const noexcept { return m_scene_index; }
+
+    // also a dumb setter, only the home scene should call this
+    void set_scene_index(Size idx) noexcept { m_scene_index = idx; }
+
     static Size get_safety() {
         struct Dummy final {};
         return MetaFunctions::key_for_type<Dummy>();
@@ -174,6 +190,8 @@ public:
 
 private:
     HomeScene * m_home = &HomeScene::no_scene();
+    // copies do not inherit this, they are not kept anywhere yet
+    Size m_scene_index = k_no_scene_index;
 };
 
 // ----------------------------------------------------------------------------
@@ -184,6 +202,11 @@ inline void * EntityBodyBase::downcast(Size safety) noexcept
 inline const void * EntityBodyBase::downcast(Size safety) const noexcept
     { return downcast_(safety); }
 
+/* private static */ inline EntityId EntityBodyBase::next_id() noexcept {
+    static std::atomic<EntityId> s_last_id = 0;
+    return ++s_last_id;
+}
+
 template <typename EntityType>
 /* static */ HomeSceneBase<EntityType> &
     HomeSceneBase<EntityType>::no_scene()
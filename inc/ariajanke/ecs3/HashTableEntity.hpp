@@ -78,10 +78,32 @@ public:
 
     HashTableEntity make_entity() const {
         HashTableEntity rv{SharedPtr<HashTableEntityBody>::make(*m_body)};
+        rv.m_body->table.reserve(rv.m_body->capacity_hint());
         rv.m_body->on_create(rv);
         return rv;
     }
 
+    /// @returns a new entity, in the same scene as this one, with a copy of
+    ///          each of this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    HashTableEntity clone() const {
+        HashTableEntity rv{SharedPtr<HashTableEntityBody>::make(*m_body)};
+        rv.m_body->table.copy_from(m_body->table);
+        rv.m_body->frozen.copy_from(m_body->frozen);
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, belonging to no scene, with a copy of each of
+    ///          this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    HashTableEntity clone_sceneless() const {
+        auto rv = make_sceneless_entity();
+        rv.m_body->table.copy_from(m_body->table);
+        rv.m_body->frozen.copy_from(m_body->frozen);
+        return rv;
+    }
+
     ConstHashTableEntity as_constant() const;
 
     /// Requested that the refered entity be deleted by the owning manager
@@ -98,11 +120,42 @@ public:
     Size hash() const noexcept
         { return m_body.owner_hash(); }
 
-    void remove_all() { m_body->table.remove_all(); }
+    /// @returns the id this entity was given when created, zero if this is a
+    ///          null entity
+    EntityId id() const noexcept
+        { return m_body ? m_body->id() : EntityId(0); }
+
+    void remove_all() {
+        m_body->table.remove_all();
+        m_body->frozen.release();
+        log_components_change_(ComponentChange::removed_all, TypeList<>{});
+    }
+
+    /// Moves every component into a compact, read only layout: a single
+    /// allocation, with keys sorted, and searched without branches. Meant for
+    /// entities that are done being built, and are only looked at from then
+    /// on.
+    ///
+    /// Adding or removing components thaws the entity first, moving its
+    /// components back into a hash table.
+    void freeze() { m_body->freeze(); }
+
+    /// @returns true if components are in the frozen layout
+    bool is_frozen() const noexcept { return m_body->is_frozen(); }
 
     void set_home_scene(HomeScene & home_scene)
         { m_body->set_home(home_scene); }
 
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets where the home scene keeps this entity.
+    void set_scene_index(Size idx) noexcept
+        { m_body->set_scene_index(idx); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// @returns where the home scene keeps this entity
+    Size scene_index() const noexcept
+        { return m_body->scene_index(); }
+
 private:
     friend class EntityBase<HashTableEntity>;
     friend class ConstEntityBase<HashTableEntity>;
@@ -110,9 +163,16 @@ private:
     explicit HashTableEntity(SharedPtr<HashTableEntityBody> && body_ptr):
         m_body(std::move(body_ptr)) {}
 
+    template <typename ... ChangedTypes>
+    void log_components_change_
+        (ComponentChange change, TypeList<ChangedTypes...> types) const
+        { m_body->log_components_change(*this, change, types); }
+
     template <typename T, typename ... ArgTypes>
-    T & add_with_args_(ArgTypes &&... args)
-        { return m_body->table.append<T>(std::forward<ArgTypes>(args)...); }
+    T & add_with_args_(ArgTypes &&... args) {
+        m_body->thaw();
+        return m_body->table.append<T>(std::forward<ArgTypes>(args)...);
+    }
 
     template <typename ... Types>
     Tuple<Types & ...> add_(TypeList<Types...>)
@@ -120,19 +180,29 @@ private:
 
     template <typename T, typename ... Types>
     Tuple<T &, Types & ...> add_(TypeList<T, Types...> tl) {
+        m_body->thaw();
         // do an ahead time reserve
         m_body->table.reserve_for_more(tl);
         return add_impl(tl);
     }
 
+    template <typename ... Types>
+    Tuple<Types & ...> add_blueprint_(const EntityBlueprint<Types...> & blueprint) {
+        m_body->thaw();
+        if (m_body->table.capacity_used().component_count == 0)
+            { return m_body->table.emplace_blueprint(blueprint); }
+        return add_(TypeList<Types...>{});
+    }
+
     template <typename T>
-    T * ptr_() { return m_body->table.get<T>(); }
+    T * ptr_() { return m_body->get<T>(); }
 
     template <typename T>
-    const T * cptr_() const { return m_body->table.get<T>(); }
+    const T * cptr_() const { return m_body->get<T>(); }
 
     template <typename Head, typename ... Types>
     void remove_(TypeList<Head, Types...>) {
+        m_body->thaw();
         (void)m_body->table.remove<Head>();
         remove_(TypeList<Types...>{});
     }
@@ -140,8 +210,28 @@ private:
     template <typename ... Types>
     void remove_(TypeList<Types...>) {}
 
+    template <typename ... Removes, typename ... Adds>
+    void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>) {
+        // removing only marks space as lost, so the one reservation is free
+        // to leave it behind
+        m_body->thaw();
+        remove_(TypeList<Removes...>{});
+        m_body->table.reserve_for_more(TypeList<Adds...>{});
+    }
+
     bool is_null_() const noexcept { return !m_body; }
 
+    Size storage_generation_() const noexcept
+        { return m_body->generation(); }
+
+    void reserve_capacity_(const CapacityHint & hint) {
+        m_body->thaw();
+        m_body->table.reserve(hint);
+    }
+
+    CapacityHint capacity_used_() const noexcept
+        { return m_body->capacity_used(); }
+
     auto as_weak_ptr_() const noexcept
         { return WeakPtr<EntityBodyBase>{m_body}; }
 
@@ -210,10 +300,13 @@ protected:
     // I do not want double implementation!
 
     template <typename T>
-    const T * cptr_() const { return m_body->table.get<T>(); }
+    const T * cptr_() const { return m_body->get<T>(); }
 
     bool is_null_() const noexcept { return !m_body; }
 
+    Size storage_generation_() const noexcept
+        { return m_body->generation(); }
+
     auto as_weak_cptr_() const noexcept
         { return WeakPtr<const EntityBodyBase>{m_body}; }
 
@@ -0,0 +1,285 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/entity-common.hpp>
+#include <ariajanke/ecs3/detail/HybridEntity.hpp>
+
+namespace ecs {
+
+template <typename ... HotTypes>
+class ConstHybridEntity;
+
+/// An entity with a fixed slot, in its body, for each of the given "hot"
+/// component types; every other component goes to a hash table.
+///
+/// Finding a hot component is a test of one bit, at a place known at compile
+/// time. So when most lookups are for a handful of types (like positions, and
+/// velocities), those types may be listed here, and skip hashing entirely.
+template <typename ... HotTypes>
+class HybridEntity final : public EntityBase<HybridEntity<HotTypes...>> {
+public:
+    using HomeScene   = HomeSceneBase<HybridEntity>;
+    using ConstEntity = ConstHybridEntity<HotTypes...>;
+    using Body        = HybridEntityBody<HotTypes...>;
+
+    HybridEntity() {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit HybridEntity(const EntityRef & ref):
+        m_body(ref.get_body<Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit HybridEntity(EntityRef && ref):
+        m_body(ref.get_body<Body>(Body::get_safety()))
+    {}
+
+    HybridEntity(const HybridEntity &) = default;
+
+    HybridEntity(HybridEntity &&) = default;
+
+    static HybridEntity make_sceneless_entity()
+        { return HybridEntity{SharedPtr<Body>::make()}; }
+
+    HybridEntity & operator = (const HybridEntity &) = default;
+
+    HybridEntity & operator = (HybridEntity &&) = default;
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const HybridEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const HybridEntity & rhs) const { return m_body != rhs.m_body; }
+
+    HybridEntity make_entity() const {
+        HybridEntity rv{SharedPtr<Body>::make(*m_body)};
+        rv.m_body->cold.reserve(rv.m_body->capacity_hint());
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, in the same scene as this one, with a copy of
+    ///          each of this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    HybridEntity clone() const {
+        HybridEntity rv{SharedPtr<Body>::make(*m_body)};
+        rv.m_body->copy_from(*m_body);
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, belonging to no scene, with a copy of each of
+    ///          this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    HybridEntity clone_sceneless() const {
+        auto rv = make_sceneless_entity();
+        rv.m_body->copy_from(*m_body);
+        return rv;
+    }
+
+    ConstEntity as_constant() const;
+
+    /// Requested that the refered entity be deleted by the owning manager
+    /// object. Entities cannot delete themselves.
+    void request_deletion()
+        { m_body->on_deletion_request(*this); }
+
+    /// Swaps components between two entities.
+    void swap(HybridEntity & rhs) { std::swap(m_body, rhs.m_body); }
+
+    /// @note hash code cannnot be guaranteed to be unique if the code outlives
+    ///       it's original entity
+    /// @returns a unique hash code that identifies this entity
+    Size hash() const noexcept
+        { return m_body.owner_hash(); }
+
+    /// @returns the id this entity was given when created, zero if this is a
+    ///          null entity
+    EntityId id() const noexcept
+        { return m_body ? m_body->id() : EntityId(0); }
+
+    void remove_all() {
+        m_body->remove_all();
+        log_components_change_(ComponentChange::removed_all, TypeList<>{});
+    }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets the home scene component.
+    void set_home_scene(HomeScene & home_scene)
+        { m_body->set_home(home_scene); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets where the home scene keeps this entity.
+    void set_scene_index(Size idx) noexcept
+        { m_body->set_scene_index(idx); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// @returns where the home scene keeps this entity
+    Size scene_index() const noexcept
+        { return m_body->scene_index(); }
+
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+private:
+    friend class EntityBase<HybridEntity>;
+    friend class ConstEntityBase<HybridEntity>;
+
+    explicit HybridEntity(SharedPtr<Body> && body_ptr):
+        m_body(std::move(body_ptr)) {}
+
+    template <typename ... ChangedTypes>
+    void log_components_change_
+        (ComponentChange change, TypeList<ChangedTypes...> types) const
+        { m_body->log_components_change(*this, change, types); }
+
+    template <typename T, typename ... ArgTypes>
+    T & add_with_args_(ArgTypes &&... args)
+        { return m_body->template append<T>(std::forward<ArgTypes>(args)...); }
+
+    template <typename ... Types>
+    Tuple<Types & ...> add_(TypeList<Types...> tl) {
+        // one reservation, so that no reference handed back is moved by a
+        // later append
+        m_body->reserve_for_more(tl);
+        return Tuple<Types & ...>{m_body->template append<Types>()...};
+    }
+
+    template <typename ... Types>
+    Tuple<Types & ...> add_blueprint_(const EntityBlueprint<Types...> &)
+        { return add_(TypeList<Types...>{}); }
+
+    template <typename T>
+    T * ptr_() noexcept { return m_body->template get<T>(); }
+
+    template <typename T>
+    const T * cptr_() const noexcept { return m_body->template get<T>(); }
+
+    template <typename ... Types>
+    void remove_(TypeList<Types...>)
+        { ((void)m_body->template remove<Types>(), ...); }
+
+    template <typename ... Removes, typename ... Adds>
+    void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>) {
+        remove_(TypeList<Removes...>{});
+        m_body->reserve_for_more(TypeList<Adds...>{});
+    }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->generation(); }
+
+    // hot slots are always there, so only the table is reserved, or counted
+    void reserve_capacity_(const CapacityHint & hint)
+        { m_body->cold.reserve(hint); }
+
+    CapacityHint capacity_used_() const noexcept
+        { return m_body->cold.capacity_used(); }
+
+    auto as_weak_ptr_() const noexcept
+        { return WeakPtr<EntityBodyBase>{m_body}; }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    SharedPtr<Body> m_body;
+#   endif
+};
+
+template <typename ... HotTypes>
+class ConstHybridEntity final : public ConstEntityBase<ConstHybridEntity<HotTypes...>> {
+public:
+    using Body = HybridEntityBody<HotTypes...>;
+
+    ConstHybridEntity() {}
+
+    explicit ConstHybridEntity(const SharedPtr<const Body> & body_ptr):
+        m_body(body_ptr) {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstHybridEntity(const EntityRef & ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstHybridEntity(EntityRef && ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstHybridEntity(const ConstEntityRef & ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstHybridEntity(ConstEntityRef && ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const ConstHybridEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const ConstHybridEntity & rhs) const { return m_body != rhs.m_body; }
+
+private:
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+    friend class ConstEntityBase<ConstHybridEntity>;
+
+    template <typename T>
+    const T * cptr_() const noexcept { return m_body->template get<T>(); }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->generation(); }
+
+    SharedPtr<const Body> m_body;
+#   endif
+};
+
+// ------------------------------- INTERFACE END ------------------------------
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <typename ... HotTypes>
+ConstHybridEntity<HotTypes...> HybridEntity<HotTypes...>::as_constant() const
+    { return ConstEntity{m_body}; }
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+} // end of ecs namespace
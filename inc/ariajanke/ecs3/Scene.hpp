@@ -28,17 +28,142 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <unordered_map>
 
 #include <ariajanke/cul/Util.hpp>
 
-#include <ariajanke/ecs3/detail/EntityRef.hpp>
+#include <ariajanke/ecs3/EntityBlueprint.hpp>
+#include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/detail/Scene.hpp>
+#include <ariajanke/ecs3/detail/SingleSystem.hpp>
 
 namespace ecs {
 
+/// Learns how much component storage entities tend to end up using.
+///
+/// Every sample raises the estimate to at least the sampled size, while
+/// older, larger samples slowly decay. This way a change in what is being
+/// spawned is followed over time, without a single odd entity inflating
+/// every allocation after it for good.
+class EntityCapacityProfile final {
+public:
+    void sample(const CapacityHint & used) {
+        m_count = decayed_max(m_count, used.component_count);
+        m_bytes = decayed_max(m_bytes, used.component_bytes);
+    }
+
+    CapacityHint hint() const
+        { return CapacityHint{from_fixed(m_count), from_fixed(m_bytes)}; }
+
+private:
+    // estimates are kept in fixed point, so that small values still decay
+    static constexpr const Size k_scale       = 256;
+    static constexpr const Size k_decay_shift = 5;
+
+    static Size decayed_max(Size estimate, Size sample)
+        { return std::max(estimate - (estimate >> k_decay_shift), sample*k_scale); }
+
+    static Size from_fixed(Size value)
+        { return (value + k_scale - 1) / k_scale; }
+
+    Size m_count = 0;
+    Size m_bytes = 0;
+};
+
+/// A cached list of a scene's entities which have every required component
+/// type, along with pointers to their components. Optional<T> types are
+/// not required, and "const T" types are passed as constant.
+///
+/// The scene keeps each view up to date as entities are created or deleted,
+/// and as they gain or lose components, doing only as much work as has
+/// changed. Like the scene itself, those changes land on its next update.
+template <typename EntityType, typename ... Types>
+class SceneView final : public SceneViewBase<EntityType> {
+public:
+    /// Calls f with each entity of the view, followed by a reference to each
+    /// required component, and an Optional for each optional one (in the
+    /// order given by the view's types).
+    /// @note component pointers are kept from one call to the next, and only
+    ///       looked up again once an entity's storage has moved
+    template <typename Func>
+    void for_each(Func && f);
+
+    /// @returns number of entities in the view, as of the scene's last update
+    Size count() const noexcept { return m_entries.size(); }
+
+    // ----------------------------- INTERFACE END ----------------------------
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+    void refresh(const EntityType &) final;
+
+    void erase(const EntityType &) final;
+
+    void clear() final;
+
+    bool depends_on(const Size * keys_beg, const Size * keys_end) const final;
+
+private:
+    template <typename T>
+    using ComponentOf = std::remove_const_t<StripOptional<T>>;
+
+    template <typename T>
+    using PointerTo = std::add_pointer_t<StripOptional<T>>;
+
+    using PointerTuple = Tuple<PointerTo<Types>...>;
+
+    struct Entry final {
+        EntityType entity;
+        PointerTuple components;
+        Size generation;
+    };
+
+    static bool matches(const EntityType & ent) {
+        return ((   IsAnOptionalType<Types>::value
+                 || ent.template has<ComponentOf<Types>>()) && ...);
+    }
+
+    static bool has_every(const PointerTuple & components) {
+        return std::apply([] (PointerTo<Types> ... ptrs)
+            { return (ptrs && ...); }, components);
+    }
+
+    static bool is_complete(const PointerTuple & components) {
+        return std::apply([] (PointerTo<Types> ... ptrs)
+            { return ((ptrs || IsAnOptionalType<Types>::value) && ...); },
+            components);
+    }
+
+    static Entry make_entry(const EntityType & ent) {
+        Entry rv{ent, PointerTuple{}, 0};
+        resolve(rv);
+        return rv;
+    }
+
+    static void resolve(Entry & entry) {
+        entry.generation = entry.entity.storage_generation();
+        entry.components = PointerTuple
+            { entry.entity.template ptr<ComponentOf<Types>>()... };
+    }
+
+    template <typename T>
+    static decltype(auto) as_argument(PointerTo<T> ptr) {
+        if constexpr (IsAnOptionalType<T>::value) return T{ptr};
+        else return *ptr;
+    }
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<EntityId, Size> m_positions;
+#   endif // DOXYGEN_SHOULD_SKIP_THIS
+};
+
+/// A scene keeps its entities in order of their ids, which makes iterating
+/// through them the same from one run of a program to the next.
 template <typename EntityType>
 class SceneOf final {
 public:
     using ConstIterator = typename std::vector<EntityType>::const_iterator;
+    using ConstView = cul::View<ConstIterator>;
 
     void update_entities()
         { m_real_home_scene.update_entities(); }
@@ -51,10 +176,29 @@ public:
 
     EntityType make_entity() {
         auto rv = EntityType::make_sceneless_entity();
+        rv.reserve_capacity(m_real_home_scene.capacity_hint());
+        add_entity(rv);
+        return rv;
+    }
+
+    /// @returns a new entity of this scene, with a copy of each of the
+    ///          prototype's components
+    /// @throws std::runtime_error if any component is not copyable
+    EntityType instantiate(const EntityType & prototype) {
+        auto rv = prototype.clone_sceneless();
         add_entity(rv);
         return rv;
     }
 
+    /// Creates new entities, each given every component of the blueprint.
+    /// @param count number of entities to create
+    /// @param init called once for each new entity, with the entity followed
+    ///             by a reference to each of its new components (in the
+    ///             blueprint's order)
+    template <typename Blueprint, typename InitFunc>
+    void spawn(Size count, InitFunc && init)
+        { spawn_(typename Blueprint::ComponentTypes{}, count, init); }
+
     ConstIterator begin() const { return m_real_home_scene.begin(); }
 
     ConstIterator end() const { return m_real_home_scene.end(); }
@@ -64,22 +208,77 @@ public:
 
     auto count() const noexcept { return end() - begin(); }
 
+    /// Has the scene keep an index of which entities have a component of
+    /// type T, so that systems which require one need only visit those.
+    /// @note an entity joins (or leaves) an index on the first update after
+    ///       gaining (or losing) the component, or as soon as it is added to
+    ///       the scene
+    template <typename T>
+    void track_component()
+        { m_real_home_scene.template track_component<T>(); }
+
+    /// @returns entities which may have every given component type: those of
+    ///          the smallest index among the types tracked, or every entity
+    ///          if none are
+    template <typename ... Types>
+    ConstView candidates_having() const {
+        const auto & entities = m_real_home_scene.template candidates_having<Types...>();
+        return ConstView{entities.begin(), entities.end()};
+    }
+
+    /// @returns key of the component type whose index candidates_having
+    ///          uses for the same types, or zero if it gives every entity
+    template <typename ... Types>
+    Size candidates_key() const {
+        const auto * index = m_real_home_scene.template smallest_index_of<Types...>();
+        return index ? index->key() : 0;
+    }
+
+    /// @returns true if the scene keeps an index of which entities have a
+    ///          component of type T
+    template <typename T>
+    bool is_tracking() const
+        { return m_real_home_scene.template index_of<T>(); }
+
+    /// @returns how many entities have a component of type T, as of the last
+    ///          update, if T is tracked; otherwise every entity is counted
+    template <typename T>
+    Size population_of() const
+        { return m_real_home_scene.template population_of<T>(); }
+
+    /// @returns the scene's view of entities with the given component types,
+    ///          which is made the first time it is asked for, and kept up to
+    ///          date from then on
+    template <typename ... Types>
+    SceneView<EntityType, Types...> & view()
+        { return m_real_home_scene.template view<Types...>(); }
+
 private:
     using Iterator = typename std::vector<EntityType>::iterator;
     using IteratorView = cul::View<Iterator>;
 
+    template <typename ... Types, typename InitFunc>
+    void spawn_(TypeList<Types...>, Size count, InitFunc & init);
+
     void set_home_scene_for(IteratorView view) {
         for (auto & new_ent : view) {
             new_ent.set_home_scene(m_real_home_scene);
         }
     }
 
+    /// Each entity's body knows where it is kept in the active container,
+    /// so that membership checks take constant time. Active entities are
+    /// kept sorted by id: new ones are radix sorted and (almost always)
+    /// simply appended, since ids only increase.
     class HomeSceneComplete final : public HomeSceneBase<EntityType> {
     public:
         void on_create(const EntityType &) final;
 
         void on_deletion_request(const EntityType &) final;
 
+        CapacityHint capacity_hint() const final
+            { return m_capacity_profile.hint(); }
+
         void update_entities();
 
         IteratorView add_entity(const EntityType &);
@@ -92,13 +291,62 @@ private:
 
         void clear();
 
-        static bool compare_entities(const EntityType & lhs, const EntityType & rhs)
-            { return lhs.hash() < rhs.hash(); }
+        template <typename T>
+        void track_component();
+
+        template <typename ... Types>
+        const std::vector<EntityType> & candidates_having() const;
+
+        // @returns the smallest index among the types, if any are tracked
+        template <typename ... Types>
+        const ComponentIndex<EntityType> * smallest_index_of() const;
+
+        template <typename T>
+        const ComponentIndex<EntityType> * index_of() const;
+
+        template <typename ... Types>
+        SceneView<EntityType, Types...> & view();
+
+        template <typename T>
+        Size population_of() const;
 
     private:
+        using ViewPtr = std::unique_ptr<SceneViewBase<EntityType>>;
+
+        static constexpr const Size k_no_scene_index =
+            EntityBodyIntr<EntityType>::k_no_scene_index;
+
+        static bool compare_ids(const EntityType & lhs, const EntityType & rhs)
+            { return lhs.id() < rhs.id(); }
+
+        bool is_active(const EntityType &) const noexcept;
+
+        /// removes every requested entity, keeping the rest in order
+        void remove_requested();
+
+        /// sorts and merges entities appended after the given index
+        /// @returns index of the first active entity which was moved
+        Size place_appended(Size old_size);
+
+        /// sets where each active entity, starting at the given index, is kept
+        void index_from(Size);
+
+        /// brings the entity's place in every index and view up to date
+        void refresh_tracked(const EntityType &);
+
+        void erase_tracked(const EntityType &);
+
+        /// brings indices and views up to date with the change log
+        void apply_change_log();
+
         std::vector<EntityType> m_new_entities;
         std::vector<EntityType> m_active_entities;
         std::vector<EntityType> m_to_remove_entities;
+        std::vector<EntityType> m_sort_scratch;
+        std::vector<ComponentIndex<EntityType>> m_component_indices;
+        // views are keyed by their type
+        std::vector<Tuple<Size, ViewPtr>> m_views;
+        EntityCapacityProfile m_capacity_profile;
     };
 
     HomeSceneComplete m_real_home_scene;
@@ -106,37 +354,42 @@ private:
 
 
 template <typename EntityType>
-void SceneOf<EntityType>::HomeSceneComplete::update_entities() {
-    for (auto * cont : { &m_active_entities, &m_to_remove_entities }) {
-        std::sort(cont->begin(), cont->end(), compare_entities);
+template <typename ... Types, typename InitFunc>
+/* private */ void SceneOf<EntityType>::spawn_
+    (TypeList<Types...>, Size count, InitFunc & init)
+{
+    for (Size i = 0; i != count; ++i) {
+        auto ent = EntityType::make_sceneless_entity();
+        std::apply([&init, &ent] (Types & ... components) {
+            init(ent, components...);
+        }, ent.add(EntityBlueprint<Types...>{}));
+        add_entity(ent);
     }
-    {
-    auto rmitr = m_to_remove_entities.begin();
-    auto cnitr = m_active_entities.begin();
-    while (rmitr != m_to_remove_entities.end()) {
-        assert(cnitr != m_active_entities.end());
-        if (*cnitr == *rmitr) {
-            *rmitr = *cnitr = EntityType{};
-            ++rmitr;
+}
+
+template <typename EntityType>
+void SceneOf<EntityType>::HomeSceneComplete::update_entities() {
+    // entities are (usually) fully built by their first update, and are
+    // certainly done by the time they are removed
+    for (auto * cont : { &m_new_entities, &m_to_remove_entities }) {
+        for (const auto & ent : *cont) {
+            m_capacity_profile.sample(ent.capacity_used());
         }
-        ++cnitr;
     }
-    m_active_entities.erase(
-        std::remove(m_active_entities.begin(), m_active_entities.end(), EntityType{}),
-        m_active_entities.end());
-    m_to_remove_entities.clear();
-    }
-    {
+    remove_requested();
+
+    radix_sort_by_id(m_new_entities, m_sort_scratch);
     auto old_size = m_active_entities.size();
-    m_active_entities.resize(old_size*2 + m_new_entities.size());
-    std::merge(
-        m_active_entities.begin(), m_active_entities.begin() + old_size,
-        m_new_entities.begin(), m_new_entities.end(),
-        m_active_entities.begin() + old_size,
-        compare_entities);
-    m_active_entities.erase(m_active_entities.begin(), m_active_entities.begin() + old_size);
-    m_new_entities.clear();
+    m_active_entities.insert
+        (m_active_entities.end(), m_new_entities.begin(), m_new_entities.end());
+    (void)place_appended(old_size);
+
+    // components may have been copied in before their entity was created
+    for (const auto & ent : m_new_entities) {
+        refresh_tracked(ent);
     }
+    m_new_entities.clear();
+    apply_change_log();
 }
 
 template <typename EntityType>
@@ -144,7 +397,9 @@ typename SceneOf<EntityType>::IteratorView
     SceneOf<EntityType>::HomeSceneComplete::add_entity(const EntityType & ent)
 {
     m_active_entities.push_back(ent);
-    return IteratorView{ m_active_entities.end() - 1, m_active_entities.end() };
+    refresh_tracked(ent);
+    auto first = place_appended(m_active_entities.size() - 1);
+    return IteratorView{ m_active_entities.begin() + first, m_active_entities.end() };
 }
 
 template <typename EntityType>
@@ -152,16 +407,88 @@ typename SceneOf<EntityType>::IteratorView
     SceneOf<EntityType>::HomeSceneComplete::add_entities
     (const std::vector<EntityType> & vec)
 {
+    auto sorted = vec;
+    radix_sort_by_id(sorted, m_sort_scratch);
+    for (const auto & ent : sorted) {
+        refresh_tracked(ent);
+    }
     auto old_size = m_active_entities.size();
-    m_active_entities.insert(m_active_entities.end(), vec.begin(), vec.end());
-    return IteratorView{ m_active_entities.begin() + old_size, m_active_entities.end() };
+    m_active_entities.insert(m_active_entities.end(), sorted.begin(), sorted.end());
+    auto first = place_appended(old_size);
+    return IteratorView{ m_active_entities.begin() + first, m_active_entities.end() };
 }
 
 template <typename EntityType>
 void SceneOf<EntityType>::HomeSceneComplete::clear() {
-    for (auto * cont : { &m_active_entities, &m_to_remove_entities, &m_active_entities }) {
+    for (auto & ent : m_active_entities) {
+        ent.set_scene_index(k_no_scene_index);
+    }
+    for (auto * cont : { &m_new_entities, &m_active_entities, &m_to_remove_entities }) {
         cont->clear();
     }
+    for (auto & index : m_component_indices) {
+        index.clear();
+    }
+    for (auto & [key, view] : m_views) {
+        (void)key;
+        view->clear();
+    }
+    this->clear_change_log();
+}
+
+template <typename EntityType>
+template <typename T>
+void SceneOf<EntityType>::HomeSceneComplete::track_component() {
+    auto index = ComponentIndex<EntityType>::template make_for<T>();
+    for (const auto & tracked : m_component_indices) {
+        if (tracked.key() == index.key()) return;
+    }
+    for (const auto & ent : m_active_entities) {
+        index.refresh(ent);
+    }
+    m_component_indices.emplace_back(std::move(index));
+    this->start_logging_changes();
+}
+
+template <typename EntityType>
+template <typename ... Types>
+const std::vector<EntityType> &
+    SceneOf<EntityType>::HomeSceneComplete::candidates_having() const
+{
+    const auto * index = smallest_index_of<Types...>();
+    return index ? index->entities() : m_active_entities;
+}
+
+template <typename EntityType>
+template <typename ... Types>
+const ComponentIndex<EntityType> *
+    SceneOf<EntityType>::HomeSceneComplete::smallest_index_of() const
+{
+    const ComponentIndex<EntityType> * rv = nullptr;
+    auto smallest = m_active_entities.size();
+    const std::array<Size, sizeof...(Types)> keys
+        { MetaFunctions::key_for_type<Types>()... };
+    for (const auto & index : m_component_indices) {
+        if (index.entities().size() < smallest &&
+            std::find(keys.begin(), keys.end(), index.key()) != keys.end())
+        {
+            rv = &index;
+            smallest = index.entities().size();
+        }
+    }
+    return rv;
+}
+
+template <typename EntityType>
+template <typename T>
+const ComponentIndex<EntityType> *
+    SceneOf<EntityType>::HomeSceneComplete::index_of() const
+{
+    const auto key = MetaFunctions::key_for_type<T>();
+    for (const auto & index : m_component_indices) {
+        if (index.key() == key) return &index;
+    }
+    return nullptr;
 }
 
 template <typename EntityType>
@@ -173,10 +500,201 @@ template <typename EntityType>
 /* private */ void SceneOf<EntityType>::HomeSceneComplete::
     on_deletion_request(const EntityType & ent)
 {
-    if (!std::binary_search(m_active_entities.begin(), m_active_entities.end(), ent, compare_entities)) {
+    if (!is_active(ent)) {
         throw InvArg("HomeScene::on_deletion_request: attempted to entity which does not belong to it's 'own' scene. (Home set wrong?)");
     }
     m_to_remove_entities.push_back(ent);
 }
 
+template <typename EntityType>
+/* private */ bool SceneOf<EntityType>::HomeSceneComplete::
+    is_active(const EntityType & ent) const noexcept
+{
+    // an index may be left over from another scene (or a cleared one)
+    auto idx = ent.scene_index();
+    return idx < m_active_entities.size() && m_active_entities[idx] == ent;
+}
+
+template <typename EntityType>
+/* private */ void SceneOf<EntityType>::HomeSceneComplete::
+    remove_requested()
+{
+    // removed entities are marked by their index first, as the same entity
+    // may have been requested more than once
+    auto first = m_active_entities.size();
+    for (const auto & ent : m_to_remove_entities) {
+        if (!is_active(ent)) continue;
+        first = std::min(first, ent.scene_index());
+        m_active_entities[ent.scene_index()].set_scene_index(k_no_scene_index);
+        erase_tracked(ent);
+    }
+    m_to_remove_entities.clear();
+
+    auto write = first;
+    for (auto read = first; read != m_active_entities.size(); ++read) {
+        auto & ent = m_active_entities[read];
+        if (ent.scene_index() == k_no_scene_index) continue;
+        ent.set_scene_index(write);
+        if (read != write) m_active_entities[write] = std::move(ent);
+        ++write;
+    }
+    m_active_entities.resize(write);
+}
+
+template <typename EntityType>
+/* private */ Size SceneOf<EntityType>::HomeSceneComplete::
+    place_appended(Size old_size)
+{
+    auto beg = m_active_entities.begin();
+    auto mid = beg + old_size;
+    if (mid == m_active_entities.end()) return old_size;
+    // entities made or cloned before the newest active one was
+    auto first = std::upper_bound(beg, mid, *mid, compare_ids);
+    std::inplace_merge(first, mid, m_active_entities.end(), compare_ids);
+    index_from(first - beg);
+    return first - beg;
+}
+
+template <typename EntityType>
+template <typename T>
+Size SceneOf<EntityType>::HomeSceneComplete::population_of() const {
+    const auto * index = index_of<T>();
+    return index ? index->entities().size() : m_active_entities.size();
+}
+
+template <typename EntityType>
+template <typename ... Types>
+SceneView<EntityType, Types...> & SceneOf<EntityType>::HomeSceneComplete::view() {
+    using View = SceneView<EntityType, Types...>;
+    const auto key = MetaFunctions::key_for_type<View>();
+    for (auto & [view_key, view] : m_views) {
+        if (view_key == key) return static_cast<View &>(*view);
+    }
+    auto view = std::make_unique<View>();
+    for (const auto & ent : m_active_entities) {
+        view->refresh(ent);
+    }
+    auto & rv = *view;
+    m_views.emplace_back(key, std::move(view));
+    this->start_logging_changes();
+    return rv;
+}
+
+template <typename EntityType>
+/* private */ void SceneOf<EntityType>::HomeSceneComplete::
+    refresh_tracked(const EntityType & ent)
+{
+    for (auto & index : m_component_indices) {
+        index.refresh(ent);
+    }
+    for (auto & [key, view] : m_views) {
+        (void)key;
+        view->refresh(ent);
+    }
+}
+
+template <typename EntityType>
+/* private */ void SceneOf<EntityType>::HomeSceneComplete::
+    erase_tracked(const EntityType & ent)
+{
+    for (auto & index : m_component_indices) {
+        index.erase(ent);
+    }
+    for (auto & [key, view] : m_views) {
+        (void)key;
+        view->erase(ent);
+    }
+}
+
+template <typename EntityType>
+/* private */ void SceneOf<EntityType>::HomeSceneComplete::apply_change_log() {
+    // records are applied in order, so the last one on any entity and type
+    // is what sticks
+    this->change_log().for_each([this]
+        (const EntityType & ent, ComponentChange change,
+         const Size * keys_beg, const Size * keys_end)
+    {
+        if (!is_active(ent)) return;
+        for (auto & index : m_component_indices) {
+            if (change == ComponentChange::removed_all) {
+                index.erase(ent);
+            } else if (std::find(keys_beg, keys_end, index.key()) != keys_end) {
+                if (change == ComponentChange::added) index.insert(ent);
+                else                                  index.erase(ent);
+            }
+        }
+        // a view's match depends on several types, so it looks for itself
+        for (auto & [key, view] : m_views) {
+            (void)key;
+            if (   change == ComponentChange::removed_all
+                || view->depends_on(keys_beg, keys_end))
+            { view->refresh(ent); }
+        }
+    });
+    this->clear_change_log();
+}
+
+template <typename EntityType>
+/* private */ void SceneOf<EntityType>::HomeSceneComplete::
+    index_from(Size first)
+{
+    for (auto idx = first; idx != m_active_entities.size(); ++idx) {
+        m_active_entities[idx].set_scene_index(idx);
+    }
+}
+
+template <typename EntityType, typename ... Types>
+template <typename Func>
+void SceneView<EntityType, Types...>::for_each(Func && f) {
+    for (auto & entry : m_entries) {
+        // like a component handle: missing (optional) components are looked
+        // for again, as adding one need not move storage
+        if (   entry.generation != entry.entity.storage_generation()
+            || !has_every(entry.components))
+        { resolve(entry); }
+        // may have lost a required component since the last update
+        if (!is_complete(entry.components)) continue;
+        std::apply([&f, &entry] (PointerTo<Types> ... ptrs) {
+            f(entry.entity, as_argument<Types>(ptrs)...);
+        }, entry.components);
+    }
+}
+
+template <typename EntityType, typename ... Types>
+void SceneView<EntityType, Types...>::refresh(const EntityType & ent) {
+    if (!matches(ent)) return erase(ent);
+    auto [itr, is_new] = m_positions.try_emplace(ent.id(), m_entries.size());
+    if (is_new) m_entries.push_back(make_entry(ent));
+    else        resolve(m_entries[itr->second]);
+}
+
+template <typename EntityType, typename ... Types>
+void SceneView<EntityType, Types...>::erase(const EntityType & ent) {
+    auto itr = m_positions.find(ent.id());
+    if (itr == m_positions.end()) return;
+    auto pos = itr->second;
+    m_positions.erase(itr);
+    if (pos + 1 != m_entries.size()) {
+        m_entries[pos] = std::move(m_entries.back());
+        m_positions[m_entries[pos].entity.id()] = pos;
+    }
+    m_entries.pop_back();
+}
+
+template <typename EntityType, typename ... Types>
+void SceneView<EntityType, Types...>::clear() {
+    m_entries.clear();
+    m_positions.clear();
+}
+
+template <typename EntityType, typename ... Types>
+bool SceneView<EntityType, Types...>::depends_on
+    (const Size * keys_beg, const Size * keys_end) const
+{
+    return (   (std::find(keys_beg, keys_end,
+                          MetaFunctions::key_for_type<ComponentOf<Types>>())
+                != keys_end)
+            || ...);
+}
+
 } // end of ecs namespace
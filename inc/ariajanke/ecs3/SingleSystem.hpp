@@ -32,6 +32,7 @@
 
 #include <type_traits>
 #include <memory>
+#include <utility>
 
 namespace ecs {
 
@@ -58,23 +59,58 @@ private:
     Type * m_ptr;
 };
 
+/// Functor argument which excludes any entity with a component of type T.
+/// It carries nothing, and only narrows which entities a functor is called
+/// on.
+template <typename T>
+struct Without final {};
+
+/// Functor argument which excludes any entity which has none of the given
+/// component types.
+template <typename ... Types>
+struct AnyOf final {};
+
 template <typename EntityType>
 class SingleSystemBase {
 public:
     virtual ~SingleSystemBase() {}
 
-    void operator () (const SceneOf<EntityType> & scene) const {
-        for (auto e : scene)
-            { operate(e); }
-    }
+    void operator () (const SceneOf<EntityType> & scene) const
+        { operate_on_scene(scene); }
 
     void operator () (EntityType & ent) const
         { operate(ent); }
 
 protected:
     virtual void operate(EntityType &) const = 0;
+
+    /// Operates on each entity of the scene, which systems may narrow down
+    /// to those with the components they need.
+    virtual void operate_on_scene(const SceneOf<EntityType> & scene) const {
+        for (auto e : scene)
+            { operate(e); }
+    }
 };
 
+/// Runs a system made by make_singles_system on each entity of a scene.
+///
+/// The system's exact type is known here, so its functors are called
+/// directly, and may be inlined into the loop, where calling the system
+/// through SingleSystemBase costs a virtual call per entity.
+///
+/// Only systems with a run_on taking the scene are accepted here, any other
+/// SingleSystemBase derived type is run through the overload below.
+template <typename EntityType, typename SystemType,
+          typename = decltype(std::declval<const SystemType &>()
+              .run_on(std::declval<const SceneOf<EntityType> &>()))>
+void run(const SceneOf<EntityType> & scene, const SystemType & system)
+    { system.run_on(scene); }
+
+/// Runs a type erased system on each entity of a scene.
+template <typename EntityType>
+void run(const SceneOf<EntityType> & scene, const SingleSystemBase<EntityType> & system)
+    { system(scene); }
+
 template <typename EntityType, typename ... Functors>
 using SinglesSystemFromFunctors =
     typename SinglesSystemFromFunctors_<EntityType, Functors...>::Type;
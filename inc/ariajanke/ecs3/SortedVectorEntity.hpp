@@ -0,0 +1,276 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/entity-common.hpp>
+#include <ariajanke/ecs3/detail/SortedVectorEntity.hpp>
+
+namespace ecs {
+
+class ConstSortedVectorEntity;
+
+/// An entity whose components live in one allocation, behind a sorted run of
+/// type keys.
+///
+/// Best suited to entities with few components (about sixteen or less).
+class SortedVectorEntity final : public EntityBase<SortedVectorEntity> {
+public:
+    using HomeScene   = HomeSceneBase<SortedVectorEntity>;
+    using ConstEntity = ConstSortedVectorEntity;
+
+    SortedVectorEntity() {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit SortedVectorEntity(const EntityRef & ref):
+        m_body(ref.get_body<SortedVectorEntityBody>(SortedVectorEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit SortedVectorEntity(EntityRef && ref):
+        m_body(ref.get_body<SortedVectorEntityBody>(SortedVectorEntityBody::get_safety()))
+    {}
+
+    SortedVectorEntity(const SortedVectorEntity &) = default;
+
+    SortedVectorEntity(SortedVectorEntity &&) = default;
+
+    static SortedVectorEntity make_sceneless_entity()
+        { return SortedVectorEntity{SharedPtr<SortedVectorEntityBody>::make()}; }
+
+    SortedVectorEntity & operator = (const SortedVectorEntity &) = default;
+
+    SortedVectorEntity & operator = (SortedVectorEntity &&) = default;
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const SortedVectorEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const SortedVectorEntity & rhs) const { return m_body != rhs.m_body; }
+
+    SortedVectorEntity make_entity() const {
+        SortedVectorEntity rv{SharedPtr<SortedVectorEntityBody>::make(*m_body)};
+        rv.m_body->components.reserve(rv.m_body->capacity_hint());
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, in the same scene as this one, with a copy of
+    ///          each of this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    SortedVectorEntity clone() const {
+        SortedVectorEntity rv{SharedPtr<SortedVectorEntityBody>::make(*m_body)};
+        rv.m_body->components.copy_from(m_body->components);
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, belonging to no scene, with a copy of each of
+    ///          this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    SortedVectorEntity clone_sceneless() const {
+        auto rv = make_sceneless_entity();
+        rv.m_body->components.copy_from(m_body->components);
+        return rv;
+    }
+
+    ConstSortedVectorEntity as_constant() const;
+
+    /// Requested that the refered entity be deleted by the owning manager
+    /// object. Entities cannot delete themselves.
+    void request_deletion()
+        { m_body->on_deletion_request(*this); }
+
+    /// Swaps component arrays between two entities.
+    void swap(SortedVectorEntity & rhs) { std::swap(m_body, rhs.m_body); }
+
+    /// @note hash code cannnot be guaranteed to be unique if the code outlives
+    ///       it's original entity
+    /// @returns a unique hash code that identifies this entity
+    Size hash() const noexcept
+        { return m_body.owner_hash(); }
+
+    /// @returns the id this entity was given when created, zero if this is a
+    ///          null entity
+    EntityId id() const noexcept
+        { return m_body ? m_body->id() : EntityId(0); }
+
+    void remove_all() {
+        m_body->components.remove_all();
+        log_components_change_(ComponentChange::removed_all, TypeList<>{});
+    }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets the home scene component.
+    void set_home_scene(HomeScene & home_scene)
+        { m_body->set_home(home_scene); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets where the home scene keeps this entity.
+    void set_scene_index(Size idx) noexcept
+        { m_body->set_scene_index(idx); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// @returns where the home scene keeps this entity
+    Size scene_index() const noexcept
+        { return m_body->scene_index(); }
+
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+private:
+    friend class EntityBase<SortedVectorEntity>;
+    friend class ConstEntityBase<SortedVectorEntity>;
+
+    explicit SortedVectorEntity(SharedPtr<SortedVectorEntityBody> && body_ptr):
+        m_body(std::move(body_ptr)) {}
+
+    template <typename ... ChangedTypes>
+    void log_components_change_
+        (ComponentChange change, TypeList<ChangedTypes...> types) const
+        { m_body->log_components_change(*this, change, types); }
+
+    template <typename T, typename ... ArgTypes>
+    T & add_with_args_(ArgTypes &&... args)
+        { return m_body->components.append<T>(std::forward<ArgTypes>(args)...); }
+
+    template <typename ... Types>
+    Tuple<Types & ...> add_(TypeList<Types...> tl) {
+        // one reservation, so that no reference handed back is moved by a
+        // later append
+        m_body->components.reserve_for_more(tl);
+        return Tuple<Types & ...>{m_body->components.append<Types>()...};
+    }
+
+    // components are already placed together
+    template <typename ... Types>
+    Tuple<Types & ...> add_blueprint_(const EntityBlueprint<Types...> &)
+        { return add_(TypeList<Types...>{}); }
+
+    template <typename T>
+    T * ptr_() noexcept { return m_body->components.get<T>(); }
+
+    template <typename T>
+    const T * cptr_() const noexcept { return m_body->components.get<T>(); }
+
+    template <typename ... Types>
+    void remove_(TypeList<Types...>)
+        { ((void)m_body->components.remove<Types>(), ...); }
+
+    template <typename ... Removes, typename ... Adds>
+    void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>) {
+        remove_(TypeList<Removes...>{});
+        m_body->components.reserve_for_more(TypeList<Adds...>{});
+    }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->components.generation(); }
+
+    void reserve_capacity_(const CapacityHint & hint)
+        { m_body->components.reserve(hint); }
+
+    CapacityHint capacity_used_() const noexcept
+        { return m_body->components.capacity_used(); }
+
+    auto as_weak_ptr_() const noexcept
+        { return WeakPtr<EntityBodyBase>{m_body}; }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    SharedPtr<SortedVectorEntityBody> m_body;
+#   endif
+};
+
+class ConstSortedVectorEntity final : public ConstEntityBase<ConstSortedVectorEntity> {
+public:
+    ConstSortedVectorEntity() {}
+
+    explicit ConstSortedVectorEntity(const SharedPtr<const SortedVectorEntityBody> & body_ptr):
+        m_body(body_ptr) {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstSortedVectorEntity(const EntityRef & ref):
+        m_body(ref.get_body<const SortedVectorEntityBody>(SortedVectorEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstSortedVectorEntity(EntityRef && ref):
+        m_body(ref.get_body<const SortedVectorEntityBody>(SortedVectorEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstSortedVectorEntity(const ConstEntityRef & ref):
+        m_body(ref.get_body<const SortedVectorEntityBody>(SortedVectorEntityBody::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstSortedVectorEntity(ConstEntityRef && ref):
+        m_body(ref.get_body<const SortedVectorEntityBody>(SortedVectorEntityBody::get_safety()))
+    {}
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const ConstSortedVectorEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const ConstSortedVectorEntity & rhs) const { return m_body != rhs.m_body; }
+
+private:
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+    friend class ConstEntityBase<ConstSortedVectorEntity>;
+
+    template <typename T>
+    const T * cptr_() const noexcept { return m_body->components.get<T>(); }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->components.generation(); }
+
+    SharedPtr<const SortedVectorEntityBody> m_body;
+#   endif
+};
+
+// ------------------------------- INTERFACE END ------------------------------
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+inline ConstSortedVectorEntity SortedVectorEntity::as_constant() const
+    { return ConstSortedVectorEntity{m_body}; }
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+} // end of ecs namespace
@@ -0,0 +1,299 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/entity-common.hpp>
+#include <ariajanke/ecs3/detail/StaticEntity.hpp>
+
+namespace ecs {
+
+template <typename ... Types>
+class ConstStaticEntity;
+
+/// An entity which may only have components of the given types, each of
+/// which has a fixed place in the entity's body.
+///
+/// Finding a component is a test of one bit, and asking for any other type
+/// returns nullptr without looking at anything. Adding, or removing, any
+/// other type does not compile.
+///
+/// Best suited to entities whose components are known ahead of time (like
+/// singletons, or those used by systems for their own book keeping).
+template <typename ... Types>
+class StaticEntity final : public EntityBase<StaticEntity<Types...>> {
+public:
+    using HomeScene   = HomeSceneBase<StaticEntity>;
+    using ConstEntity = ConstStaticEntity<Types...>;
+    using Body        = StaticEntityBody<Types...>;
+
+    /// @returns true if this entity type may have components of type T
+    template <typename T>
+    static constexpr const bool k_may_have = InlineComponentSlots<Types...>::template k_has_slot_for<T>;
+
+    StaticEntity() {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit StaticEntity(const EntityRef & ref):
+        m_body(ref.get_body<Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit StaticEntity(EntityRef && ref):
+        m_body(ref.get_body<Body>(Body::get_safety()))
+    {}
+
+    StaticEntity(const StaticEntity &) = default;
+
+    StaticEntity(StaticEntity &&) = default;
+
+    static StaticEntity make_sceneless_entity()
+        { return StaticEntity{SharedPtr<Body>::make()}; }
+
+    StaticEntity & operator = (const StaticEntity &) = default;
+
+    StaticEntity & operator = (StaticEntity &&) = default;
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const StaticEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const StaticEntity & rhs) const { return m_body != rhs.m_body; }
+
+    StaticEntity make_entity() const {
+        StaticEntity rv{SharedPtr<Body>::make(*m_body)};
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, in the same scene as this one, with a copy of
+    ///          each of this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    StaticEntity clone() const {
+        StaticEntity rv{SharedPtr<Body>::make(*m_body)};
+        rv.m_body->slots.copy_from(m_body->slots);
+        rv.m_body->on_create(rv);
+        return rv;
+    }
+
+    /// @returns a new entity, belonging to no scene, with a copy of each of
+    ///          this entity's components
+    /// @throws std::runtime_error if any component is not copyable
+    StaticEntity clone_sceneless() const {
+        auto rv = make_sceneless_entity();
+        rv.m_body->slots.copy_from(m_body->slots);
+        return rv;
+    }
+
+    ConstEntity as_constant() const;
+
+    /// Requested that the refered entity be deleted by the owning manager
+    /// object. Entities cannot delete themselves.
+    void request_deletion()
+        { m_body->on_deletion_request(*this); }
+
+    /// Swaps components between two entities.
+    void swap(StaticEntity & rhs) { std::swap(m_body, rhs.m_body); }
+
+    /// @note hash code cannnot be guaranteed to be unique if the code outlives
+    ///       it's original entity
+    /// @returns a unique hash code that identifies this entity
+    Size hash() const noexcept
+        { return m_body.owner_hash(); }
+
+    /// @returns the id this entity was given when created, zero if this is a
+    ///          null entity
+    EntityId id() const noexcept
+        { return m_body ? m_body->id() : EntityId(0); }
+
+    void remove_all() {
+        m_body->slots.remove_all();
+        log_components_change_(ComponentChange::removed_all, TypeList<>{});
+    }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets the home scene component.
+    void set_home_scene(HomeScene & home_scene)
+        { m_body->set_home(home_scene); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// This method sets where the home scene keeps this entity.
+    void set_scene_index(Size idx) noexcept
+        { m_body->set_scene_index(idx); }
+
+    /// <strong>Not intended for client use.</strong>
+    /// @returns where the home scene keeps this entity
+    Size scene_index() const noexcept
+        { return m_body->scene_index(); }
+
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+private:
+    friend class EntityBase<StaticEntity>;
+    friend class ConstEntityBase<StaticEntity>;
+
+    template <typename ... OtherTypes>
+    static constexpr const bool k_may_have_all = (k_may_have<OtherTypes> && ...);
+
+    explicit StaticEntity(SharedPtr<Body> && body_ptr):
+        m_body(std::move(body_ptr)) {}
+
+    template <typename ... ChangedTypes>
+    void log_components_change_
+        (ComponentChange change, TypeList<ChangedTypes...> types) const
+        { m_body->log_components_change(*this, change, types); }
+
+    template <typename T, typename ... ArgTypes>
+    T & add_with_args_(ArgTypes &&... args) {
+        static_assert(k_may_have<T>, "StaticEntity cannot have this component type.");
+        return m_body->slots.template emplace<T>(std::forward<ArgTypes>(args)...);
+    }
+
+    template <typename ... AddTypes>
+    Tuple<AddTypes & ...> add_(TypeList<AddTypes...>) {
+        static_assert(k_may_have_all<AddTypes...>,
+                      "StaticEntity cannot have one or more of these component types.");
+        // slots never move, so nothing needs reserving
+        return Tuple<AddTypes & ...>{m_body->slots.template emplace<AddTypes>()...};
+    }
+
+    template <typename ... AddTypes>
+    Tuple<AddTypes & ...> add_blueprint_(const EntityBlueprint<AddTypes...> &)
+        { return add_(TypeList<AddTypes...>{}); }
+
+    template <typename T>
+    T * ptr_() noexcept { return m_body->slots.template get<T>(); }
+
+    template <typename T>
+    const T * cptr_() const noexcept { return m_body->slots.template get<T>(); }
+
+    template <typename ... RemoveTypes>
+    void remove_(TypeList<RemoveTypes...>) {
+        static_assert(k_may_have_all<RemoveTypes...>,
+                      "StaticEntity cannot have one or more of these component types.");
+        ((void)m_body->slots.template remove<RemoveTypes>(), ...);
+    }
+
+    template <typename ... Removes, typename ... Adds>
+    void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>) {
+        static_assert(k_may_have_all<Adds...>,
+                      "StaticEntity cannot have one or more of these component types.");
+        remove_(TypeList<Removes...>{});
+    }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->slots.generation(); }
+
+    // every slot is already part of the body
+    void reserve_capacity_(const CapacityHint &) {}
+
+    CapacityHint capacity_used_() const noexcept
+        { return CapacityHint{}; }
+
+    auto as_weak_ptr_() const noexcept
+        { return WeakPtr<EntityBodyBase>{m_body}; }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    SharedPtr<Body> m_body;
+#   endif
+};
+
+template <typename ... Types>
+class ConstStaticEntity final : public ConstEntityBase<ConstStaticEntity<Types...>> {
+public:
+    using Body = StaticEntityBody<Types...>;
+
+    ConstStaticEntity() {}
+
+    explicit ConstStaticEntity(const SharedPtr<const Body> & body_ptr):
+        m_body(body_ptr) {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstStaticEntity(const EntityRef & ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstStaticEntity(EntityRef && ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstStaticEntity(const ConstEntityRef & ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @brief Completes an entity reference, allowing client code to access
+    ///        the components associated with the entity.
+    explicit ConstStaticEntity(ConstEntityRef && ref):
+        m_body(ref.get_body<const Body>(Body::get_safety()))
+    {}
+
+    /// @returns True if two entities refer to the same components.
+    bool operator == (const ConstStaticEntity & rhs) const { return m_body == rhs.m_body; }
+
+    /// @returns True if two entities refer to different components.
+    bool operator != (const ConstStaticEntity & rhs) const { return m_body != rhs.m_body; }
+
+private:
+#   ifndef DOXYGEN_SHOULD_SKIP_THIS
+    friend class ConstEntityBase<ConstStaticEntity>;
+
+    template <typename T>
+    const T * cptr_() const noexcept { return m_body->slots.template get<T>(); }
+
+    auto as_weak_cptr_() const noexcept
+        { return WeakPtr<const EntityBodyBase>{m_body}; }
+
+    bool is_null_() const noexcept { return !m_body; }
+
+    Size storage_generation_() const noexcept
+        { return m_body->slots.generation(); }
+
+    SharedPtr<const Body> m_body;
+#   endif
+};
+
+// ------------------------------- INTERFACE END ------------------------------
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <typename ... Types>
+ConstStaticEntity<Types...> StaticEntity<Types...>::as_constant() const
+    { return ConstEntity{m_body}; }
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+} // end of ecs namespace
@@ -37,6 +37,7 @@
 #include <ariajanke/ecs3/detail/defs.hpp>
 
 #include <atomic>
+#include <cstring>
 
 namespace ecs {
 
@@ -98,6 +99,15 @@ public:
     ///          be equal to "dest_addr"
     virtual void * move(void * src, void * dest_addr) const = 0;
 
+    /// Copy constructs a new instance of the type.
+    /// @warning unsafe code; follow documentation as exactly as possible
+    /// @param src An existing instance of type, which is left untouched.
+    /// @param dest_addr A properly aligned space where an instance of the type
+    ///                  may live.
+    /// @throws std::runtime_error if the type cannot be copied
+    /// @returns address to the new instance
+    virtual void * copy(const void * src, void * dest_addr) const = 0;
+
     /// Destroys an instance of type at addr. An object <em>must</em> exist at
     /// addr, or the behavior is undefined.
     /// @param addr address to an existing object
@@ -189,6 +199,21 @@ template <typename T>
             return new (to_space) T{ std::move(*reinterpret_cast<T *>(from)) };
         }
 
+        void * copy(const void * from, void * to_space) const final {
+            static constexpr auto k_not_copyable =
+                "MetaFunctions::copy: component type is not copyable.";
+            // a type may be trivially copyable, with its copy constructor
+            // deleted, so that's checked first
+            if constexpr (!std::is_copy_constructible_v<T>) {
+                throw RtError(k_not_copyable);
+            } else if constexpr (std::is_trivially_copyable_v<T>) {
+                std::memcpy(to_space, from, sizeof(T));
+                return reinterpret_cast<T *>(to_space);
+            } else {
+                return new (to_space) T(*reinterpret_cast<const T *>(from));
+            }
+        }
+
         void destroy(void * obj) const final
             { reinterpret_cast<T *>(obj)->~T(); }
 
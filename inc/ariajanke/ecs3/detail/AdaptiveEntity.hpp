@@ -0,0 +1,170 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/defs.hpp>
+#include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/detail/HashTableEntity.hpp>
+#include <ariajanke/ecs3/detail/SortedVectorEntity.hpp>
+
+namespace ecs {
+
+class AdaptiveEntity;
+
+/** Holds components either in a sorted array (while few), or in a hash table
+ *  (once many), moving them between the two as the count crosses either
+ *  threshold.
+ *
+ *  The thresholds are apart, so that an entity which gains and loses a
+ *  component or two, right at the boundary, does not move every time.
+ */
+class AdaptiveEntityBody final : public EntityBodyIntr<AdaptiveEntity> {
+public:
+    /// past this many components, they are moved to the hash table
+    static constexpr const Size k_to_table_count =
+        SortedComponentArray::k_linear_search_limit;
+
+    /// below this many components, they are moved back to the sorted array
+    static constexpr const Size k_to_array_count = k_to_table_count / 2;
+
+    AdaptiveEntityBody() {}
+
+    AdaptiveEntityBody(const AdaptiveEntityBody & body):
+        Super(body) {}
+
+    explicit AdaptiveEntityBody(HomeScene * home): Super(home) {}
+
+    template <typename T>
+    T * get() const
+        { return m_uses_table ? table.get<T>() : array.get<T>(); }
+
+    bool uses_table() const noexcept { return m_uses_table; }
+
+    Size count() const noexcept {
+        return m_uses_table ? table.capacity_used().component_count
+                            : array.size();
+    }
+
+    Size generation() const noexcept
+        { return array.generation() + table.generation(); }
+
+    CapacityHint capacity_used() const
+        { return m_uses_table ? table.capacity_used() : array.capacity_used(); }
+
+    /// Moves components to whichever layout suits the given number of them.
+    void adapt_to(Size count);
+
+    /// Moves components to the hash table if there are to be more than the
+    /// array is for, but never back to the array. Adds use this, as an edit
+    /// settles layout before its first add.
+    void grow_to(Size count);
+
+    /// Copies every component of another body into this (empty) one, in the
+    /// same layout.
+    /// @throws std::runtime_error if any component is not copyable
+    void copy_from(const AdaptiveEntityBody &);
+
+    void remove_all();
+
+    SortedComponentArray array;
+    HeterogeneousHashTable table;
+
+private:
+    using Super = EntityBodyIntr<AdaptiveEntity>;
+
+    const void * downcast_(Size safety_) const noexcept final {
+        if (safety_ == get_safety()) return this;
+        return nullptr;
+    }
+
+    void move_to_table();
+
+    void move_to_array();
+
+    bool m_uses_table = false;
+};
+
+// ---------------------------- AdaptiveEntityBody ----------------------------
+
+inline void AdaptiveEntityBody::adapt_to(Size count) {
+    if (!m_uses_table && count > k_to_table_count) {
+        move_to_table();
+    } else if (m_uses_table && count < k_to_array_count) {
+        move_to_array();
+    }
+}
+
+inline void AdaptiveEntityBody::grow_to(Size count) {
+    if (!m_uses_table && count > k_to_table_count)
+        { move_to_table(); }
+}
+
+inline void AdaptiveEntityBody::copy_from(const AdaptiveEntityBody & rhs) {
+    assert(count() == 0);
+    array.copy_from(rhs.array);
+    try {
+        table.copy_from(rhs.table);
+    } catch (...) {
+        array.remove_all();
+        throw;
+    }
+    m_uses_table = rhs.m_uses_table;
+}
+
+inline void AdaptiveEntityBody::remove_all() {
+    array.remove_all();
+    table.remove_all();
+}
+
+/* private */ inline void AdaptiveEntityBody::move_to_table() {
+    try {
+        table.reserve(array.capacity_used());
+        array.for_each([this] (Size, void * ptr, const MetaFunctions & mf)
+            { table.append_moved(ptr, mf); });
+    } catch (...) {
+        table.remove_all();
+        throw;
+    }
+    array.release();
+    m_uses_table = true;
+}
+
+/* private */ inline void AdaptiveEntityBody::move_to_array() {
+    try {
+        array.reserve(table.capacity_used());
+        table.for_each([this] (void * ptr, const MetaFunctions & mf)
+            { array.append_moved(ptr, mf); });
+    } catch (...) {
+        array.remove_all();
+        throw;
+    }
+    table.release();
+    m_uses_table = false;
+}
+
+} // end of ecs namespace
@@ -28,19 +28,20 @@
 
 #include <ariajanke/ecs3/defs.hpp>
 #include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/detail/SortedVectorEntity.hpp>
 
 #include <memory>
+#include <array>
+#include <bitset>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
 
 #include <cassert>
 
 namespace ecs {
 
-class NodeSource {
-public:
-    virtual ~NodeSource() {}
-    virtual void decrement(void *) noexcept = 0;
-};
-
 class NodeInstanceAttn;
 
 class NodeInstance;
@@ -51,15 +52,75 @@ struct NodeDeletor final {
 
 using NodeOwningPtr = std::unique_ptr<NodeInstance, NodeDeletor>;
 
+class NodeSource {
+public:
+    virtual ~NodeSource() {}
+    virtual void decrement(void *) noexcept = 0;
+    // makes a new (lone) node, with a copy of the given datum
+    virtual NodeOwningPtr copy_node(const void *) const = 0;
+    // destroys the datum, but keeps its space for a later datum of the same
+    // type
+    // @returns false if the source cannot keep the space (and so the datum is
+    //          left untouched)
+    virtual bool vacate(void *) noexcept = 0;
+    // marks a datum as living again, following its construction on a
+    // vacated space
+    virtual void revive(void *) noexcept = 0;
+    // @returns true if any vacated space of this source is still owned
+    virtual bool keeps_vacated() const noexcept = 0;
+    // @returns the number of owners a datum's node has, beyond its first
+    virtual int & share_count(const void *) noexcept = 0;
+    // @returns meta functions for the datum's type
+    virtual const MetaFunctions & metafunctions(const void *) const noexcept = 0;
+};
+
+// Recycles memory for tree nodes, sorted by size (in units of maximum
+// alignment). Each thread keeps its own free lists, with a limit on how
+// many blocks each may hold.
+class NodePool final {
+public:
+    static void * allocate(Size size);
+
+    static void deallocate(void * ptr, Size size) noexcept;
+
+private:
+    static constexpr const Size k_unit = alignof(std::max_align_t);
+    static constexpr const Size k_size_class_count = 32;
+    static constexpr const Size k_max_free_per_class = 64;
+
+    struct FreeBlock final { FreeBlock * next = nullptr; };
+
+    struct FreeLists final {
+        FreeLists() {}
+        FreeLists(const FreeLists &) = delete;
+        FreeLists & operator = (const FreeLists &) = delete;
+        ~FreeLists();
+
+        std::array<FreeBlock *, k_size_class_count> heads = {};
+        std::array<Size, k_size_class_count> counts = {};
+    };
+
+    static Size size_class_of(Size size) noexcept
+        { return (size + k_unit - 1) / k_unit - 1; }
+
+    static FreeLists * free_lists() noexcept;
+
+    // trivially destructible, so that it may still be checked while (and
+    // after) thread local objects are destroyed
+    static bool & lists_are_gone() noexcept {
+        thread_local bool inst = false;
+        return inst;
+    }
+};
+
 template <typename ... Types>
 std::array<NodeOwningPtr, sizeof...(Types)> make_multiple_type_nodes();
 
 template <typename Type, typename ... ConstructorTypes>
 NodeOwningPtr make_single_type_node(ConstructorTypes && ... args);
 
-NodeOwningPtr move_ptr(NodeInstance *&);
-
-NodeOwningPtr rebalance_left(NodeOwningPtr &);
+template <typename Type>
+NodeOwningPtr copy_single_type_node(const void * datum);
 
 // :TODO: refactor down to keys (no types!)
 // I will absolutely need to test my AVL operations!
@@ -145,12 +206,6 @@ public:
             removed(std::move(rm_))
         {}
 
-        BstRemoveRes append_to_super(NodeOwningPtr && super_root, NodeInstance *& side) {
-            using std::move;
-            assert(!side);
-            side = root.release();
-            return BstRemoveRes{move(affected), move(super_root), move(removed)};
-        }
         // [NTS]
         // consider what this should look like for various tree structures...
         //
@@ -172,10 +227,45 @@ public:
     // insert... which... returns the new root node
     static AvlInsertRes avl_insert(NodeOwningPtr root, NodeOwningPtr newnode);
 
-    // static NodeOwningPtr avl_remove(NodeOwningPtr & root, Size key);
-
     static bool is_avl(const NodeOwningPtr & root)
         { return is_avl(root.get()); }
+
+    // copies an entire tree, shape and all (so no rebalancing is needed)
+    static NodeOwningPtr copy_tree(const NodeInstance * root);
+
+    // Builds a perfectly balanced tree from (childless) nodes, sorted by key.
+    static NodeOwningPtr build_balanced(NodeOwningPtr * beg, NodeOwningPtr * end);
+
+    // Joins (childless) nodes, sorted by key, with a tree. If there are about
+    // as many new nodes as old ones, the whole tree is laid out again,
+    // perfectly balanced, in one pass; so there are no rotations. Otherwise
+    // each is inserted on its own.
+    static NodeOwningPtr join_sorted
+        (NodeOwningPtr root, NodeOwningPtr * beg, NodeOwningPtr * end);
+
+    // Trees may share nodes (and so components). A shared node is never
+    // changed, instead it's copied (along with every node above it) for the
+    // tree that means to change it.
+
+    // @returns another owner of the same tree, without copying anything
+    static NodeOwningPtr share(const NodeOwningPtr & root);
+
+    // Copies each shared node on the way to the given key.
+    // @throws if any copied node's component is not copyable
+    // @returns true if anything was copied
+    static bool unshare_path(NodeOwningPtr & root, Size key);
+
+    // Copies each shared node that inserting, or removing, the given key
+    // may change (including the nodes rotations may move).
+    // @throws if any copied node's component is not copyable
+    // @returns true if anything was copied
+    static bool unshare_for_change(NodeOwningPtr & root, Size key);
+
+    // Calls f with each node's datum, its meta functions, and whether it's
+    // shared with another tree (itself, or through any node above it), in
+    // key order.
+    template <typename Func>
+    static void for_each_in_order(const NodeInstance * root, Func && f);
 private:
     static bool is_avl(const NodeInstance * root) {
         // an empty tree is (assumed) AVL
@@ -185,147 +275,140 @@ private:
     }
 
 private:
+    // Links followed from the root, down to some node (or to the empty link
+    // where it would be). Each link is the field that points to the next
+    // node, so the tree may be restructured in place, without recursion.
+    class NodePath final {
+    public:
+        // an AVL tree this tall would need more components than there are
+        // addresses
+        static constexpr const int k_max_length = 96;
+
+        explicit NodePath(NodeInstance *& root) { push(root); }
+
+        void push(NodeInstance *& link) {
+            assert(m_length < k_max_length);
+            m_links[m_length++] = &link;
+        }
 
-    static NodeInstance *& find_inorder_successor(NodeInstance *& node, Size key) {
-        static NodeInstance * k_null = nullptr;
-        if (!node) return k_null;
-        if (!node->m_left && !node->m_right && node->key() > key)
-            { return node; }
-        auto & res = find_inorder_successor(node->m_left, key);
-        if (res) return res;
-        return find_inorder_successor(node->m_right, key);
-    }
+        void replace(int idx, NodeInstance *& link) { m_links[idx] = &link; }
 
-    static BstRemoveRes bst_remove_on_side
-        (NodeOwningPtr & root, ChildParentRef sided_subtree, Size key)
-    {
-        // [NTS]
-        // side is the parent, and we're always searching through the right child
-        // I need to draw this out a bit I think
-        // we want side's parent? yes
-        assert(sided_subtree.parent);
-        assert(sided_subtree.child_pointer()->key() == key);
-        auto & side = sided_subtree.child_pointer();
-        auto & lc = side->m_left;
-        auto & rc = side->m_right;
-        using std::move;
-        if (lc && rc) {
-            // two node case
-            // note: reference to pointer
-            auto & suc = find_inorder_successor(rc, key);
-            assert(suc);
-            suc->swap_content(*side);
-            // post swap, remove successor
-            // the entire subtree is affected
-            return BstRemoveRes{move(sided_subtree), move(root), move_ptr(suc)};
-        }
-        // one or none case
-        auto rmvd = move_ptr(side);
-        side = lc ? lc : rc;
-        if (!side) return BstRemoveRes{move(root), move(rmvd)};
+        NodeInstance *& operator [] (int idx) const { return *m_links[idx]; }
 
-        // only one part of the sub tree is affected
-        return BstRemoveRes{move(sided_subtree), move(root), move(rmvd)};
-    }
+        NodeInstance *& back() const { return *m_links[m_length - 1]; }
+
+        int length() const noexcept { return m_length; }
+
+    private:
+        std::array<NodeInstance **, k_max_length> m_links;
+        int m_length = 0;
+    };
+
+    static NodePath find_path(NodeInstance *& root, Size key);
+
+    // Calls f with each node in key order. A node's links are read before
+    // it's passed, so f may unlink it.
+    template <typename Func>
+    static void for_each_node_in_order(NodeInstance * root, Func && f);
+
+    // Unlinks the node at the end of the path, keeping the tree a BST.
+    // @returns the removed node (with no children) and the index of the
+    //          deepest link whose subtree may need rebalancing
+    static Tuple<NodeInstance *, int> unlink_back(NodePath &);
+
+    // rebalances each subtree on the path, from "from" up to the root,
+    // stopping as soon as a subtree's height is unchanged
+    static void rebalance_path(const NodePath &, int from);
+
+    // @returns new root of the subtree
+    static NodeInstance * rebalance(NodeInstance *);
+
+    static NodeInstance * rotate_right(NodeInstance *);
+
+    static NodeInstance * rotate_left(NodeInstance *);
 
 public:
+    // Removes a node, without any rebalancing.
     // bst remove should be tested also
-    static BstRemoveRes bst_remove(NodeOwningPtr root, Size key) {
-        using std::move;
-        auto has_key = [key](NodeInstance * node)
-            { return node ? node->key() == key : false; };
-        auto do_recur_on_side = [key, &root](NodeInstance *& side)
-            { return bst_remove(move_ptr(side), key).append_to_super(move(root), side); };
-        auto do_side_has_key = [key, &root](NodeInstance *& side)
-            { return bst_remove_on_side(root, ChildParentRef{root.get(), side}, key); };
-
-        if (!root) return BstRemoveRes{};
-        if (has_key(root.get())) {
-            // still pretty DRY
-            auto & lc = root->m_left;
-            auto & rc = root->m_right;
-            if (lc && rc) {
-                // two node case
-                // note: reference to pointer
-                auto & suc = find_inorder_successor(rc, key);
-                assert(suc);
-                suc->swap_content(*root);
-                // post swap, remove successor
-                // the entire subtree is affected
-                return BstRemoveRes{move(root), move_ptr(suc)};
-            }
-            // one or none case
-            return BstRemoveRes{move_ptr(lc ? lc : rc), move(root)};
-        }
-        if (has_key(root->m_left))
-            { return do_side_has_key(root->m_left); }
-        if (has_key(root->m_right))
-            { return do_side_has_key(root->m_right); }
-        if (root->m_left && key < root->key())
-            { return do_recur_on_side(root->m_left); }
-        if (root->m_right && key > root->key())
-            { return do_recur_on_side(root->m_right); }
-        return BstRemoveRes{move(root), nullptr};
-    }
-
-    static AvlRemoveRes avl_remove(NodeOwningPtr root, Size key) {
-        using std::move;
-        auto [affected, root_, removed_] = bst_remove(move(root), key); {}
-        if (removed_ && root_ && affected.parent) {
-            affected.child_pointer()->update_balance();
-            // for rebalancing we must also the parent of the "affected" node
-            // in house knowledge: the right side of the tree may become "lighter"
-            auto subtree = move_ptr(affected.child_pointer());
-            subtree = rebalance_left(subtree);
-            affected.child_pointer() = subtree.release();
-        }
-        return AvlRemoveRes{move(root_), move(removed_)};
-    }
+    static BstRemoveRes bst_remove(NodeOwningPtr root, Size key);
+
+    static AvlRemoveRes avl_remove(NodeOwningPtr root, Size key);
+
 public:
     template <typename Type>
     Tuple<NodeOwningPtr, Type *> split();
 
     Size key() const noexcept { return m_key; }
 
-    int height() const;
+    int height() const noexcept { return m_height; }
 
-    void update_balance();
+    void update_height() noexcept;
 
     void * ptr_(Size sought) const;
 
-    int balance() const { return m_balance; }
+    // @returns the datum for the given key (or nullptr), and whether any
+    //          node on the way there is shared with another tree
+    Tuple<void *, bool> find(Size sought) const noexcept;
 
-    void swap(NodeInstance & rhs) {
-        using std::swap;
-        swap(m_datum  , rhs.m_datum  );
-        swap(m_key    , rhs.m_key    );
-        swap(m_left   , rhs.m_left   );
-        swap(m_right  , rhs.m_right  );
-        swap(m_source , rhs.m_source );
-        swap(m_balance, rhs.m_balance);
-    }
+    int balance() const noexcept;
 
-    // invalidates balance
-    void swap_content(NodeInstance & rhs) {
-        using std::swap;
-        swap(m_datum , rhs.m_datum );
-        swap(m_key   , rhs.m_key   );
-        swap(m_source, rhs.m_source);
-    }
+    void * datum() const noexcept
+        { return const_cast<Byte *>(as_bytes()) + m_datum_offset; }
+
+    // destroys this node's datum, keeping its space for reuse
+    // @returns false if the node should just be let go instead
+    bool vacate() noexcept { return source()->vacate(datum()); }
+
+    // call after constructing a new datum on a vacated node
+    void revive() noexcept { source()->revive(datum()); }
+
+    // @returns true if a node made together with this one is vacated, and
+    //          still held somewhere
+    bool source_keeps_vacated() const noexcept
+        { return source()->keeps_vacated(); }
+
+    // @returns true if both nodes were made together, in one allocation
+    bool shares_source_with(const NodeInstance & other) const noexcept
+        { return source() == other.source(); }
 
 protected:
-    NodeInstance(void * datum_, Size key_):
-        m_datum(datum_), m_key(key_)
-    { assert(key_ != Size(-1) && key_ != 0); }
+    // datum must follow the node, in the same object
+    NodeInstance(void * datum_, Size key_);
 
 private:
+    using Byte = std::byte;
+
+    const Byte * as_bytes() const noexcept
+        { return reinterpret_cast<const Byte *>(this); }
+
+    NodeSource * source() const noexcept {
+        assert(m_source_offset);
+        return reinterpret_cast<NodeSource *>(
+            const_cast<Byte *>(as_bytes()) - m_source_offset);
+    }
+
+    // source must contain the node
+    void set_source(NodeSource * source_) noexcept;
+
+    void add_share() noexcept;
+
+    void release_share() noexcept;
+
+    // @returns a lone copy of this node, which shares its children
+    NodeOwningPtr shared_copy() const;
+
+    static bool make_private(NodeInstance *& link);
+
+    static bool make_private(NodeOwningPtr & root);
+
     void decrement_children() {
         // NodeInstance may own it's child nodes
         auto on_ = [](NodeInstance * side) {
             if (!side) return;
+            // another tree still has it
+            if (side->m_shared) return side->release_share();
             side->decrement_children();
-            assert(side->m_source);
-            side->m_source->decrement(side->m_datum);
+            side->source()->decrement(side->datum());
         };
         on_(m_left );
         on_(m_right);
@@ -333,27 +416,28 @@ private:
 
     // to rotate -> must rotatable at root
 
-    // there's a *lot* of overhead...
-    void * m_datum = nullptr;
+    // The datum, and the source, are in the same object as the node. So
+    // they are found by offsets from the node rather than by pointers,
+    // which keeps the node to four words.
     Size m_key = 0;
     NodeInstance * m_left = nullptr;
     NodeInstance * m_right = nullptr;
     // owner calls decrement...
-    NodeSource * m_source = nullptr;
-    int m_balance = 0;
+    // how far back (in bytes) the source is from this node
+    std::uint32_t m_source_offset = 0;
+    // how far forward (in bytes) the datum is from this node
+    std::uint16_t m_datum_offset = 0;
+    // cached, so that balancing only looks at immediate children
+    std::int8_t m_height = 1;
+    // true if the source counts any more owners for this node
+    bool m_shared = false;
 };
 
-NodeOwningPtr rebalance_right(NodeOwningPtr &);
-
-NodeOwningPtr rebalance_left(NodeOwningPtr &);
-
-NodeOwningPtr rotate_right(NodeOwningPtr);
-
-NodeOwningPtr rotate_left(NodeOwningPtr);
-
 template <typename T>
 class SingleNode;
 
+class ErasedNode;
+
 class NodeInstanceAttn {
     template <typename ... Types>
     friend class MultiNodeImpl;
@@ -361,23 +445,19 @@ class NodeInstanceAttn {
     template <typename T>
     friend class SingleNode;
 
-    friend struct NodeDeletor;
-
-    friend NodeOwningPtr rebalance_right(NodeOwningPtr &);
+    friend class ErasedNode;
 
-    friend NodeOwningPtr rebalance_left(NodeOwningPtr &);
-
-    friend NodeOwningPtr rotate_right(NodeOwningPtr);
-
-    friend NodeOwningPtr rotate_left(NodeOwningPtr);
+    friend struct NodeDeletor;
 
     static void set_source(NodeInstance & node, NodeSource * source)
-        { node.m_source = source; }
+        { node.set_source(source); }
 
     static void decrement(NodeInstance & node) {
+        // another tree still has it
+        if (node.m_shared) return node.release_share();
         node.decrement_children();
         // node may become a dangling reference following this call...
-        node.m_source->decrement(node.m_datum);
+        node.source()->decrement(node.datum());
     }
 
     static NodeInstance * left_of(NodeInstance & node)
@@ -402,7 +482,7 @@ public:
     template <typename ... Types>
     NodeForType(Types && ... args):
         NodeInstance(&m_real_datum, MetaFunctions::key_for_type<Type>())
-    { new (&m_real_datum) Type{std::forward<Types>(args)...}; }
+    { new (&m_real_datum) Type(std::forward<Types>(args)...); }
 
     std::ptrdiff_t compare(void * ptr) const noexcept {
         using Byte = std::byte;
@@ -468,19 +548,56 @@ private:
 template <typename ... Types>
 class MultiNode final : public MultiNodeImpl<Types...> {
 public:
+    static void * operator new (std::size_t size)
+        { return NodePool::allocate(size); }
+
+    static void operator delete (void * ptr, std::size_t size) noexcept
+        { NodePool::deallocate(ptr, size); }
+
     // reclaimation of components?
     // just use another tree!
+    // (the entity does just that, with vacated nodes)
     void list_out_to(NodeOwningPtr * beg, NodeOwningPtr * end);
 
     void set_source(NodeSource * source_)
         { MultiNodeImpl<Types...>::set_source(source_); }
 
-    // how can I go from datum pointer to an index? an offset?
     void decrement(void *) noexcept final;
 
+    NodeOwningPtr copy_node(const void *) const final;
+
+    bool vacate(void *) noexcept final;
+
+    void revive(void *) noexcept final;
+
+    // vacated spaces are the owners left beyond those alive
+    bool keeps_vacated() const noexcept final
+        { return Size(m_count) > m_alive.count(); }
+
+    int & share_count(const void *) noexcept final;
+
+    const MetaFunctions & metafunctions(const void *) const noexcept final;
+
     using VoidFunc = void(*)(void *);
 
 private:
+    template <typename T>
+    static constexpr Size index_of() noexcept {
+        Size idx = 0;
+        (void)((!std::is_same_v<T, Types> && ++idx) && ...);
+        return idx;
+    }
+
+    // calls f with a (null) pointer of the datum's type, and the type's
+    // index
+    template <typename Func>
+    void for_datum_(void * datum, Func && f) const {
+        for_datum_type_(TypeList<Types...>{}, datum, [&f] (auto * type_tag) {
+            using T = std::remove_pointer_t<decltype(type_tag)>;
+            f(type_tag, index_of<T>());
+        });
+    }
+
     template <typename T>
     std::ptrdiff_t compare(void * ptr) const noexcept
         { return MultiNodeImpl<Types...>::template compare<T>(ptr); }
@@ -489,12 +606,13 @@ private:
     void destruct(void * datum) const noexcept
         { MultiNodeImpl<Types...>::template destruct<T>(datum); }
 
-    template <typename ... OTypes>
-    void destruct_impl_(TypeList<OTypes...>, void *)
-        {  assert(!"Multinode of zero types call destruct!"); }
+    // calls f with a (null) pointer of the datum's type
+    template <typename Func, typename ... OTypes>
+    void for_datum_type_(TypeList<OTypes...>, void *, Func &&) const
+        {  assert(!"Multinode of zero types call for datum!"); }
 
-    template <typename Head, typename ... OTypes>
-    void destruct_impl_(TypeList<Head, OTypes...>, void * datum) {
+    template <typename Func, typename Head, typename ... OTypes>
+    void for_datum_type_(TypeList<Head, OTypes...>, void * datum, Func && f) const {
         // assumption... early type -> higher address
         using Fork = typename TypeList<Head, OTypes...>::Fork;
         using MidType = typename Fork::MiddleType;
@@ -502,19 +620,20 @@ private:
         using RightList = typename Fork::Right;
         auto diff = compare<MidType>(datum);
         if (diff == 0) {
-            destruct<MidType>(datum);
+            f(static_cast<MidType *>(nullptr));
         } else if (diff < 0) {
             // go right (actually)
             assert(RightList::k_count > 0);
-            destruct_impl_(RightList{}, datum);
+            for_datum_type_(RightList{}, datum, std::forward<Func>(f));
         } else {
             assert(LeftList::k_count > 0);
-            destruct_impl_(LeftList{}, datum);
+            for_datum_type_(LeftList{}, datum, std::forward<Func>(f));
         }
     }
 
     int m_count = sizeof...(Types);
-    NodeInstance * m_reuse_root = nullptr;
+    std::bitset<sizeof...(Types)> m_alive = std::bitset<sizeof...(Types)>{}.set();
+    std::array<int, sizeof...(Types)> m_share_counts = {};
 };
 
 template <typename T>
@@ -528,15 +647,121 @@ public:
     void set_source(NodeSource * source_)
         { NodeInstanceAttn::set_source(m_real_node, source_); }
 
+    static void * operator new (std::size_t size)
+        { return NodePool::allocate(size); }
+
+    static void operator delete (void * ptr, std::size_t size) noexcept
+        { NodePool::deallocate(ptr, size); }
+
     void decrement(void * datum) noexcept final {
         m_real_node.destruct(datum);
         delete this;
     }
 
+    NodeOwningPtr copy_node(const void * datum) const final
+        { return copy_single_type_node<T>(datum); }
+
+    // lone nodes go back to the pool instead
+    bool vacate(void *) noexcept final { return false; }
+
+    void revive(void *) noexcept final
+        { assert(!"A lone node cannot be revived."); }
+
+    bool keeps_vacated() const noexcept final { return false; }
+
+    int & share_count(const void *) noexcept final
+        { return m_share_count; }
+
+    const MetaFunctions & metafunctions(const void *) const noexcept final
+        { return MetaFunctions::for_type<T>(); }
+
     NodeInstance * node_pointer() noexcept { return &m_real_node; }
 
 private:
     NodeForType<T> m_real_node;
+    int m_share_count = 0;
+};
+
+// A lone node, whose component's type is known only through its meta
+// functions (as with components coming back from a frozen entity). The
+// component lives just past the node, in the same block.
+class ErasedNode final : public NodeSource {
+public:
+    // @returns a new node, with a component moved from the given one (which
+    //          is left to the caller to destroy)
+    static NodeOwningPtr make_moved(void * src, const MetaFunctions &);
+
+    // @throws if the component is not copyable
+    // @returns a new node, with a copy of the given component
+    static NodeOwningPtr make_copied(const void * src, const MetaFunctions &);
+
+    void decrement(void * datum) noexcept final;
+
+    NodeOwningPtr copy_node(const void * datum) const final
+        { return make_copied(datum, *m_metafunctions); }
+
+    bool vacate(void *) noexcept final { return false; }
+
+    void revive(void *) noexcept final
+        { assert(!"A lone node cannot be revived."); }
+
+    bool keeps_vacated() const noexcept final { return false; }
+
+    int & share_count(const void *) noexcept final
+        { return m_share_count; }
+
+    const MetaFunctions & metafunctions(const void *) const noexcept final
+        { return *m_metafunctions; }
+
+private:
+    using Byte = std::byte;
+
+    class Node final : public NodeInstance {
+    public:
+        Node(void * datum_, Size key_): NodeInstance(datum_, key_) {}
+    };
+
+    ErasedNode(void * datum, const MetaFunctions & mf):
+        m_node(datum, mf.key()), m_metafunctions(&mf) {}
+
+    static Size datum_offset() noexcept {
+        static constexpr const Size k_max_align = alignof(std::max_align_t);
+        return ((sizeof(ErasedNode) + k_max_align - 1) / k_max_align)*k_max_align;
+    }
+
+    static Size block_size(const MetaFunctions & mf)
+        { return datum_offset() + mf.object_size(); }
+
+    // construct is called with the space for the component
+    template <typename Func>
+    static NodeOwningPtr make_(const MetaFunctions &, Func && construct);
+
+    Node m_node;
+    const MetaFunctions * m_metafunctions;
+    int m_share_count = 0;
+};
+
+// Remembers where the most recently sought components are, so that the few
+// components a system asks for, again and again, are found without
+// descending the tree.
+class MruLookupCache final {
+public:
+    static constexpr const int k_size = 4;
+
+    // @returns the remembered datum, or nullptr if the key is not remembered
+    void * find(Size key) noexcept;
+
+    // remembers a datum as the most recently used, forgetting the least
+    void remember(Size key, void * datum) noexcept;
+
+    void forget(Size key) noexcept;
+
+    void clear() noexcept { *this = MruLookupCache{}; }
+
+private:
+    // zero is never a key, so it marks an empty entry
+    std::array<Size, k_size> m_keys = {};
+    std::array<void *, k_size> m_data = {};
 };
 
 class AvlTreeEntity;
@@ -550,7 +775,41 @@ public:
 
     explicit AvlTreeEntityBody(HomeScene * home): Super(home) {}
 
+    // @returns datum for the given key, or nullptr if there is none
+    // @note as lookups update the cache, even through constant entities,
+    //       one entity should not be read from more than one thread at a
+    //       time
+    void * find(Size key) const noexcept;
+
+    // @returns datum for the given key, or nullptr if there is none; the
+    //          datum is copied first, if it's shared with another tree
+    void * find_private(Size key);
+
+    bool is_frozen() const noexcept { return frozen.size() != 0; }
+
+    // Moves every component out of the tree, and into the frozen array, which
+    // is sized exactly. Components shared with another tree are copied
+    // instead.
+    // @throws if a shared component is not copyable
+    void freeze();
+
+    // Moves every component back into a (perfectly balanced) tree.
+    void thaw();
+
     NodeOwningPtr root;
+    // nodes (of multi-type blocks) whose components were removed, keyed by
+    // type, waiting for a component of the same type to be added again
+    NodeOwningPtr vacated;
+    // advanced whenever a node (and its component) is destroyed
+    Size storage_generation = 0;
+    // nodes never move, so only removals need to be forgotten (and only
+    // components shared with no other tree are remembered)
+    mutable MruLookupCache lookup_cache;
+    // set once the tree is shared with a snapshot, only then do changes
+    // need to copy shared nodes
+    mutable bool may_share = false;
+    // components live here, and not in the tree, while the entity is frozen
+    SortedComponentArray frozen;
 
 private:
     using Super = EntityBodyIntr<AvlTreeEntity>;
@@ -560,6 +819,125 @@ private:
     }
 };
 
+// ------------------------------ MruLookupCache ------------------------------
+
+inline void * MruLookupCache::find(Size key) noexcept {
+    for (int i = 0; i != k_size; ++i) {
+        if (m_keys[i] != key) continue;
+        auto * rv = m_data[i];
+        // bring to the front, so that the hottest are checked first
+        for (; i != 0; --i) {
+            m_keys[i] = m_keys[i - 1];
+            m_data[i] = m_data[i - 1];
+        }
+        m_keys[0] = key;
+        m_data[0] = rv;
+        return rv;
+    }
+    return nullptr;
+}
+
+inline void MruLookupCache::remember(Size key, void * datum) noexcept {
+    assert(key != 0);
+    for (int i = k_size - 1; i != 0; --i) {
+        m_keys[i] = m_keys[i - 1];
+        m_data[i] = m_data[i - 1];
+    }
+    m_keys[0] = key;
+    m_data[0] = datum;
+}
+
+inline void MruLookupCache::forget(Size key) noexcept {
+    for (int i = 0; i != k_size; ++i) {
+        if (m_keys[i] != key) continue;
+        m_keys[i] = 0;
+        m_data[i] = nullptr;
+    }
+}
+
+// ----------------------------- AvlTreeEntityBody -----------------------------
+
+inline void * AvlTreeEntityBody::find(Size key) const noexcept {
+    if (is_frozen()) return frozen.find(key);
+    if (auto * datum = lookup_cache.find(key)) return datum;
+    if (!root) return nullptr;
+    auto [datum, shared] = root->find(key); {}
+    // shared components are copied on the next change, so they are not to
+    // be remembered
+    if (datum && !shared) lookup_cache.remember(key, datum);
+    return datum;
+}
+
+inline void * AvlTreeEntityBody::find_private(Size key) {
+    if (is_frozen()) return frozen.find(key);
+    if (auto * datum = lookup_cache.find(key)) return datum;
+    if (!root) return nullptr;
+    auto [datum, shared] = root->find(key); {}
+    if (datum && shared) {
+        (void)NodeInstance::unshare_path(root, key);
+        datum = root->ptr_(key);
+        ++storage_generation;
+    }
+    if (datum) lookup_cache.remember(key, datum);
+    return datum;
+}
+
+inline void AvlTreeEntityBody::freeze() {
+    if (is_frozen() || !root) return;
+    try {
+        // room for everything is made first, so nothing may fail once
+        // components start moving out of the tree
+        CapacityHint hint;
+        NodeInstance::for_each_in_order(root.get(),
+            [&hint] (void *, const MetaFunctions & mf, bool) {
+                ++hint.component_count;
+                hint.component_bytes += mf.object_size() + mf.object_align() - 1;
+            });
+        frozen.reserve(hint);
+        // a snapshot must not see its components moved out
+        if (may_share) {
+            NodeInstance::for_each_in_order(root.get(),
+                [this] (void * datum, const MetaFunctions & mf, bool shared)
+                { if (shared) frozen.append_copied(datum, mf); });
+        }
+    } catch (...) {
+        frozen.release();
+        throw;
+    }
+    NodeInstance::for_each_in_order(root.get(),
+        [this] (void * datum, const MetaFunctions & mf, bool shared)
+        { if (!shared) frozen.append_moved(datum, mf); });
+    root.reset();
+    vacated.reset();
+    lookup_cache.clear();
+    ++storage_generation;
+    frozen.shrink_to_fit();
+}
+
+inline void AvlTreeEntityBody::thaw() {
+    if (!is_frozen()) return;
+    assert(!root);
+    std::vector<NodeOwningPtr> nodes;
+    nodes.reserve(frozen.size());
+    try {
+        frozen.for_each([&nodes] (Size, void * datum, const MetaFunctions & mf)
+            { nodes.emplace_back(ErasedNode::make_moved(datum, mf)); });
+    } catch (...) {
+        // components already moved into nodes go back where they were,
+        // before those nodes go
+        Size idx = 0;
+        frozen.for_each([&nodes, &idx] (Size, void * datum, const MetaFunctions & mf) {
+            if (idx == nodes.size()) return;
+            mf.destroy(datum);
+            mf.move(nodes[idx++]->datum(), datum);
+        });
+        throw;
+    }
+    root = NodeInstance::build_balanced(nodes.data(), nodes.data() + nodes.size());
+    frozen.release();
+    ++storage_generation;
+}
+
 // ------------------------- Tree Node implementation -------------------------
 
 inline void NodeDeletor::operator () (NodeInstance * inst) const noexcept
@@ -582,14 +960,23 @@ NodeOwningPtr make_single_type_node(ConstructorTypes && ... args) {
     return NodeOwningPtr{ node->node_pointer() };
 }
 
+template <typename Type>
+NodeOwningPtr copy_single_type_node(const void * datum) {
+    static constexpr auto k_not_copyable =
+        "copy_single_type_node: component type is not copyable.";
+    if constexpr (std::is_copy_constructible_v<Type>) {
+        return make_single_type_node<Type>(*reinterpret_cast<const Type *>(datum));
+    } else {
+        throw RtError(k_not_copyable);
+    }
+}
+
 // level 1 helpers (tree node implementations)
 
 int height_of(NodeInstance *);
 
 int height_of(const NodeOwningPtr &);
 
-NodeOwningPtr move_ptr(NodeInstance *&);
-
 // NodeInstance
 
 inline /* static */ NodeInstance::AvlInsertRes NodeInstance::avl_insert
@@ -597,126 +984,385 @@ inline /* static */ NodeInstance::AvlInsertRes NodeInstance::avl_insert
 {
     using AvlRes = NodeInstance::AvlInsertRes;
     using std::move;
-    if (!root) return AvlRes{move(newnode), nullptr};
+    assert(newnode && !newnode->m_left && !newnode->m_right);
+    auto * root_ = root.release();
+    auto path = find_path(root_, newnode->key());
+    if (path.back()) return AvlRes{NodeOwningPtr{root_}, move(newnode)};
+
+    // newnode is "consumed"
+    path.back() = newnode.release();
+    rebalance_path(path, path.length() - 2);
+    return AvlRes{NodeOwningPtr{root_}};
+}
+
+inline /* static */ NodeInstance::BstRemoveRes NodeInstance::bst_remove
+    (NodeOwningPtr root, Size key)
+{
+    auto * root_ = root.release();
+    auto path = find_path(root_, key);
+    if (!path.back()) return BstRemoveRes{NodeOwningPtr{root_}, nullptr};
+
+    auto target_idx = path.length() - 1;
+    bool had_children = path.back()->m_left || path.back()->m_right;
+    auto [removed, from] = unlink_back(path); {}
+    (void)from;
+    // if an immediate child is removed, it's not possible to have an
+    // "effected" parent-child node pair, as there is only one
+    if (target_idx > 0 && had_children) {
+        return BstRemoveRes{
+            ChildParentRef{path[target_idx - 1], path[target_idx]},
+            NodeOwningPtr{root_}, NodeOwningPtr{removed}};
+    }
+    return BstRemoveRes{NodeOwningPtr{root_}, NodeOwningPtr{removed}};
+}
+
+inline /* static */ NodeInstance::AvlRemoveRes NodeInstance::avl_remove
+    (NodeOwningPtr root, Size key)
+{
+    auto * root_ = root.release();
+    auto path = find_path(root_, key);
+    if (!path.back()) return AvlRemoveRes{NodeOwningPtr{root_}};
+
+    auto [removed, from] = unlink_back(path); {}
+    rebalance_path(path, from);
+    return AvlRemoveRes{NodeOwningPtr{root_}, NodeOwningPtr{removed}};
+}
+
+inline /* static */ NodeOwningPtr NodeInstance::copy_tree
+    (const NodeInstance * root)
+{
+    if (!root) return nullptr;
+    // children are copied first, if any copy throws, then whatever has
+    // been copied so far is cleaned up by its owning pointer
+    auto left  = copy_tree(root->m_left );
+    auto right = copy_tree(root->m_right);
+    auto rv    = root->source()->copy_node(root->datum());
+    rv->m_left   = left .release();
+    rv->m_right  = right.release();
+    rv->m_height = root->m_height;
+    return rv;
+}
 
-    auto nkey = newnode->key();
-    auto rkey = root->key();
+/* protected */ inline NodeInstance::NodeInstance(void * datum_, Size key_):
+    m_key(key_)
+{
+    assert(key_ != Size(-1) && key_ != 0);
+    auto offset = reinterpret_cast<Byte *>(datum_) - as_bytes();
+    assert(   offset >= 0
+           && Size(offset) <= Size(std::numeric_limits<std::uint16_t>::max()));
+    m_datum_offset = std::uint16_t(offset);
+}
 
-    if (nkey == rkey) return AvlRes{move(root), move(newnode)};
+/* private */ inline void NodeInstance::set_source(NodeSource * source_) noexcept {
+    auto offset = as_bytes() - reinterpret_cast<const Byte *>(source_);
+    assert(offset > 0 && Size(offset) <= std::numeric_limits<std::uint32_t>::max());
+    m_source_offset = std::uint32_t(offset);
+}
 
-    bool should_go_left = nkey < rkey;
-    auto & side = should_go_left ? root->m_left : root->m_right;
-    if (!side) {
-        // newnode is "consumed"
-        side = newnode.release();
-        root->update_balance();
-        return AvlRes{move(root)};
+/* static */ inline NodeOwningPtr NodeInstance::share(const NodeOwningPtr & root) {
+    if (!root) return nullptr;
+    root->add_share();
+    return NodeOwningPtr{root.get()};
+}
+
+/* static */ inline bool NodeInstance::unshare_path(NodeOwningPtr & root, Size key) {
+    bool copied = make_private(root);
+    for (auto * node = root.get(); node && node->m_key != key; ) {
+        auto & link = key < node->m_key ? node->m_left : node->m_right;
+        copied |= make_private(link);
+        node = link;
     }
+    return copied;
+}
 
-    // balance assumed updated post call
-    assert(side);
-    auto [nroot, nnode] = avl_insert(move_ptr(side), move(newnode));
-    side = nroot.release();
-    return AvlRes{
-        should_go_left ? rebalance_left(root) : rebalance_right(root),
-        move(nnode)};
+/* static */ inline bool NodeInstance::unshare_for_change
+    (NodeOwningPtr & root, Size key)
+{
+    bool copied = make_private(root);
+    // rebalancing may rotate any child, and promote any grandchild
+    auto around = [&copied] (NodeInstance * node) {
+        for (auto * link : { &node->m_left, &node->m_right }) {
+            copied |= make_private(*link);
+            if (!*link) continue;
+            copied |= make_private((**link).m_left );
+            copied |= make_private((**link).m_right);
+        }
+    };
+    auto * node = root.get();
+    for (; node && node->m_key != key;
+         node = key < node->m_key ? node->m_left : node->m_right)
+    { around(node); }
+    if (!node) return copied;
+    around(node);
+    // a removal may also take a successor from the right subtree
+    for (node = node->m_right; node; node = node->m_left)
+        { around(node); }
+    return copied;
 }
 
-inline int NodeInstance::height() const {
-    if (!m_left && !m_right) return 1;
-    if ( m_left &&  m_right)
-        return std::max( m_left->height(), m_right->height() ) + 1;
-    if (m_left) return m_left->height() + 1;
-    return m_right->height() + 1;
+/* private */ inline void NodeInstance::add_share() noexcept {
+    ++source()->share_count(datum());
+    m_shared = true;
 }
 
-inline void NodeInstance::update_balance() {
-    m_balance =   (m_left  ? m_left ->height() : 0)
-                - (m_right ? m_right->height() : 0);
+/* private */ inline void NodeInstance::release_share() noexcept {
+    auto & count = source()->share_count(datum());
+    assert(m_shared && count > 0);
+    m_shared = --count > 0;
 }
 
-inline void * NodeInstance::ptr_(Size sought) const {
-    if (m_key == sought) return m_datum;
-    if (m_key > sought && m_left ) return m_left ->ptr_(sought);
-    if (m_key < sought && m_right) return m_right->ptr_(sought);
-    return nullptr;
+/* private */ inline NodeOwningPtr NodeInstance::shared_copy() const {
+    auto rv = source()->copy_node(datum());
+    for (auto * child : { m_left, m_right }) {
+        if (child) child->add_share();
+    }
+    rv->m_left   = m_left;
+    rv->m_right  = m_right;
+    rv->m_height = m_height;
+    return rv;
 }
 
-// Helpers
+/* private static */ inline bool NodeInstance::make_private(NodeInstance *& link) {
+    if (!link || !link->m_shared) return false;
+    auto * copy = link->shared_copy().release();
+    link->release_share();
+    link = copy;
+    return true;
+}
 
-inline NodeOwningPtr rebalance_right(NodeOwningPtr & ptr) {
-    // the beauty of this is that it...
-    // if it is already balanced... no problem
-    // if not, it's fixed at the end
-    using Nia = NodeInstanceAttn;
-    using std::move;
-    assert(ptr);
-    assert(Nia::right_of(*ptr));
-    ptr->update_balance();
-    if (ptr->balance() != -2) return move(ptr);
-    auto right = Nia::right_of(*ptr);
-    if (right->balance() > 0)
-        Nia::set_right_of(*ptr, rotate_right(move_ptr(right)).release());
-    else
-        assert(right->balance() < 0);
-    return rotate_left(move(ptr));
-}
-
-inline NodeOwningPtr rebalance_left(NodeOwningPtr & ptr) {
-    using Nia = NodeInstanceAttn;
-    using std::move;
-    assert(ptr);
-    assert(Nia::left_of(*ptr));
-    ptr->update_balance(); // some kind of update or whatever...
-    // balance is height_of(left) - height_of(right)
-    if (ptr->balance() != 2) return move(ptr);
-    // is it a line or kink case?
-    // done on kink only
-    auto left = Nia::left_of(*ptr);
-    if (left->balance() < 0)
-        Nia::set_left_of(*ptr, rotate_left(move_ptr(left)).release());
-    else
-        assert(left->balance() > 0);
-    return rotate_right(move(ptr));
+/* private static */ inline bool NodeInstance::make_private(NodeOwningPtr & root) {
+    if (!root || !root->m_shared) return false;
+    // letting go of the old root only drops one of its shares
+    root = root->shared_copy();
+    return true;
 }
 
-inline NodeOwningPtr rotate_right(NodeOwningPtr ptr) {
-    using Nia = NodeInstanceAttn;
-    auto t  = ptr.release();
-    auto l  = Nia::left_of (*t);
-    auto lr = Nia::right_of(*l);
+/* static */ inline NodeOwningPtr NodeInstance::build_balanced
+    (NodeOwningPtr * beg, NodeOwningPtr * end)
+{
+    if (beg == end) return nullptr;
+    auto mid = beg + (end - beg) / 2;
+    auto left  = build_balanced(beg, mid);
+    auto right = build_balanced(mid + 1, end);
+    auto node  = std::move(*mid);
+    assert(node && !node->m_left && !node->m_right);
+    assert(!left  || left ->m_key < node->m_key);
+    assert(!right || right->m_key > node->m_key);
+    node->m_left  = left .release();
+    node->m_right = right.release();
+    node->update_height();
+    return node;
+}
 
-    Nia::set_right_of(*l, t );
-    Nia::set_left_of (*t, lr);
+/* static */ inline NodeOwningPtr NodeInstance::join_sorted
+    (NodeOwningPtr root, NodeOwningPtr * beg, NodeOwningPtr * end)
+{
+    static constexpr auto k_already_present =
+        "NodeInstance::join_sorted: a node with the same key is already present.";
+    if (!root) return build_balanced(beg, end);
+    for (auto itr = beg; itr != end; ++itr) {
+        if (root->ptr_((**itr).m_key))
+            { throw RtError(k_already_present); }
+    }
+    // an AVL tree has more than 2^(h/2) nodes, where h is its height; with
+    // fewer new nodes than that, inserting each costs less than laying out
+    // every node again
+    auto fewest_existing = Size(1) << (root->m_height / 2);
+    if (Size(end - beg) < fewest_existing) {
+        for (; beg != end; ++beg) {
+            auto res = avl_insert(std::move(root), std::move(*beg));
+            assert(!res.given);
+            root = std::move(res.root);
+        }
+        return root;
+    }
 
-    t->update_balance();
-    l->update_balance();
+    Size existing_count = 0;
+    for_each_node_in_order(root.get(), [&existing_count] (NodeInstance *)
+        { ++existing_count; });
+    // reserved before anything is unlinked, so that a failed allocation
+    // leaves the tree as it was
+    std::vector<NodeOwningPtr> merged;
+    merged.reserve(existing_count + Size(end - beg));
+
+    for_each_node_in_order(root.release(), [&merged, &beg, end] (NodeInstance * node) {
+        for (; beg != end && (**beg).m_key < node->m_key; ++beg)
+            { merged.emplace_back(std::move(*beg)); }
+        node->m_left = node->m_right = nullptr;
+        merged.emplace_back(node);
+    });
+    for (; beg != end; ++beg)
+        { merged.emplace_back(std::move(*beg)); }
+    return build_balanced(merged.data(), merged.data() + merged.size());
+}
 
-    // l must own the other two!
-    assert(l->ptr_(t ->key()));
-    assert(lr ? !!l->ptr_(lr->key()) : true);
+template <typename Func>
+/* private static */ void NodeInstance::for_each_node_in_order
+    (NodeInstance * root, Func && f)
+{
+    std::array<NodeInstance *, NodePath::k_max_length> stack;
+    int depth = 0;
+    for (auto * node = root; node || depth; ) {
+        for (; node; node = node->m_left)
+            { stack[depth++] = node; }
+        node = stack[--depth];
+        auto * right = node->m_right;
+        f(node);
+        node = right;
+    }
+}
 
-    return NodeOwningPtr{l};
+template <typename Func>
+/* static */ void NodeInstance::for_each_in_order
+    (const NodeInstance * root, Func && f)
+{
+    std::array<Tuple<const NodeInstance *, bool>, NodePath::k_max_length> stack;
+    int depth = 0;
+    // whether the next node is below a shared one
+    bool shared = false;
+    for (auto * node = root; node || depth; ) {
+        for (; node; node = node->m_left) {
+            shared = shared || node->m_shared;
+            stack[depth++] = std::make_tuple(node, shared);
+        }
+        auto [top, top_shared] = stack[--depth];
+        f(top->datum(), top->source()->metafunctions(top->datum()), top_shared);
+        node = top->m_right;
+        shared = top_shared;
+    }
 }
 
-inline NodeOwningPtr rotate_left(NodeOwningPtr ptr) {
-    using Nia = NodeInstanceAttn;
-    auto t  = ptr.release();
-    auto r  = Nia::right_of(*t);
-    auto rl = Nia::left_of (*r);
+inline void NodeInstance::update_height() noexcept
+    { m_height = std::int8_t(std::max(height_of(m_left), height_of(m_right)) + 1); }
 
-    Nia::set_left_of (*r, t);
-    Nia::set_right_of(*t, rl);
+inline int NodeInstance::balance() const noexcept
+    { return height_of(m_left) - height_of(m_right); }
 
-    t->update_balance();
-    r->update_balance();
+inline void * NodeInstance::ptr_(Size sought) const {
+    for (auto * node = this; node; ) {
+        if (node->m_key == sought) return node->datum();
+        node = node->m_key > sought ? node->m_left : node->m_right;
+    }
+    return nullptr;
+}
 
-    assert(r->ptr_(t ->key()));
-    assert(rl ? !!r->ptr_(rl->key()) : true);
+inline Tuple<void *, bool> NodeInstance::find(Size sought) const noexcept {
+    bool shared = false;
+    for (auto * node = this; node; ) {
+        shared |= node->m_shared;
+        if (node->m_key == sought) return std::make_tuple(node->datum(), shared);
+        node = node->m_key > sought ? node->m_left : node->m_right;
+    }
+    return std::make_tuple(nullptr, shared);
+}
+
+/* private static */ inline NodeInstance::NodePath NodeInstance::find_path
+    (NodeInstance *& root, Size key)
+{
+    NodePath path{root};
+    while (auto * node = path.back()) {
+        if (node->m_key == key) break;
+        path.push(key < node->m_key ? node->m_left : node->m_right);
+    }
+    return path;
+}
+
+/* private static */ inline Tuple<NodeInstance *, int>
+    NodeInstance::unlink_back(NodePath & path)
+{
+    using std::make_tuple;
+    auto target_idx = path.length() - 1;
+    auto * target = path.back();
+    assert(target);
+    auto * lc = target->m_left;
+    auto * rc = target->m_right;
+    if (!lc || !rc) {
+        // one or none case
+        path.back() = lc ? lc : rc;
+    } else {
+        // two node case: the inorder successor takes the target's place
+        path.push(target->m_right);
+        while (path.back()->m_left) {
+            path.push(path.back()->m_left);
+        }
+        auto * successor = path.back();
+        path.back() = successor->m_right;
+
+        successor->m_left   = target->m_left;
+        successor->m_right  = target->m_right;
+        // for now, as the target's subtree has not yet been rebalanced
+        successor->m_height = target->m_height;
+        path[target_idx] = successor;
+        // the link after the target's now belongs to the successor
+        path.replace(target_idx + 1, successor->m_right);
+    }
+    target->m_left = target->m_right = nullptr;
+    target->m_height = 1;
+    return make_tuple(target, path.length() - 2);
+}
 
-    return NodeOwningPtr{r};
+/* private static */ inline void NodeInstance::rebalance_path
+    (const NodePath & path, int from)
+{
+    for (int i = from; i >= 0; --i) {
+        auto & link = path[i];
+        auto old_height = link->m_height;
+        auto * subroot  = rebalance(link);
+        bool unchanged  = subroot == link && subroot->m_height == old_height;
+        link = subroot;
+        if (unchanged) return;
+    }
 }
 
+/* private static */ inline NodeInstance * NodeInstance::rebalance
+    (NodeInstance * node)
+{
+    // balance is height_of(left) - height_of(right)
+    node->update_height();
+    auto bal = node->balance();
+    if (bal > 1) {
+        // is it a line or kink case?
+        // done on kink only
+        if (node->m_left->balance() < 0)
+            { node->m_left = rotate_left(node->m_left); }
+        return rotate_right(node);
+    } else if (bal < -1) {
+        if (node->m_right->balance() > 0)
+            { node->m_right = rotate_right(node->m_right); }
+        return rotate_left(node);
+    }
+    return node;
+}
+
+/* private static */ inline NodeInstance * NodeInstance::rotate_right
+    (NodeInstance * t)
+{
+    auto l  = t->m_left;
+    auto lr = l->m_right;
+
+    l->m_right = t;
+    t->m_left  = lr;
+
+    t->update_height();
+    l->update_height();
+    return l;
+}
+
+/* private static */ inline NodeInstance * NodeInstance::rotate_left
+    (NodeInstance * t)
+{
+    auto r  = t->m_right;
+    auto rl = r->m_left;
+
+    r->m_left  = t;
+    t->m_right = rl;
+
+    t->update_height();
+    r->update_height();
+    return r;
+}
+
+
 // More helper types
 
 template <typename Head, typename ... Types>
@@ -745,12 +1391,145 @@ void MultiNode<Types...>::list_out_to(NodeOwningPtr * beg, NodeOwningPtr * end)
 
 template <typename ... Types>
 void MultiNode<Types...>::decrement(void * datum) noexcept {
-    destruct_impl_(TypeList<Types...>{}, datum);
+    for_datum_(datum, [this, datum] (auto * type_tag, Size idx) {
+        using T = std::remove_pointer_t<decltype(type_tag)>;
+        if (m_alive.test(idx)) destruct<T>(datum);
+    });
     if (--m_count) return;
     // I've... lost it
     delete this;
 }
 
+template <typename ... Types>
+bool MultiNode<Types...>::vacate(void * datum) noexcept {
+    // the last one alive need not keep anything, vacated slots included
+    if (m_alive.count() == 1) return false;
+    for_datum_(datum, [this, datum] (auto * type_tag, Size idx) {
+        using T = std::remove_pointer_t<decltype(type_tag)>;
+        assert(m_alive.test(idx));
+        destruct<T>(datum);
+        m_alive.reset(idx);
+    });
+    return true;
+}
+
+template <typename ... Types>
+int & MultiNode<Types...>::share_count(const void * datum) noexcept {
+    int * rv = nullptr;
+    for_datum_(const_cast<void *>(datum), [this, &rv] (auto *, Size idx)
+        { rv = &m_share_counts[idx]; });
+    assert(rv);
+    return *rv;
+}
+
+template <typename ... Types>
+void MultiNode<Types...>::revive(void * datum) noexcept {
+    for_datum_(datum, [this] (auto *, Size idx) {
+        assert(!m_alive.test(idx));
+        m_alive.set(idx);
+    });
+}
+
+template <typename ... Types>
+const MetaFunctions & MultiNode<Types...>::metafunctions
+    (const void * datum) const noexcept
+{
+    const MetaFunctions * rv = nullptr;
+    for_datum_type_(TypeList<Types...>{}, const_cast<void *>(datum), [&rv] (auto * type_tag) {
+        using T = std::remove_pointer_t<decltype(type_tag)>;
+        rv = &MetaFunctions::for_type<T>();
+    });
+    assert(rv);
+    return *rv;
+}
+
+template <typename ... Types>
+NodeOwningPtr MultiNode<Types...>::copy_node(const void * datum) const {
+    NodeOwningPtr rv;
+    for_datum_type_(TypeList<Types...>{}, const_cast<void *>(datum), [&rv, datum] (auto * type_tag) {
+        using T = std::remove_pointer_t<decltype(type_tag)>;
+        rv = copy_single_type_node<T>(datum);
+    });
+    return rv;
+}
+
+// ErasedNode
+
+/* static */ inline NodeOwningPtr ErasedNode::make_moved
+    (void * src, const MetaFunctions & mf)
+{ return make_(mf, [src, &mf] (void * space) { return mf.move(src, space); }); }
+
+/* static */ inline NodeOwningPtr ErasedNode::make_copied
+    (const void * src, const MetaFunctions & mf)
+{ return make_(mf, [src, &mf] (void * space) { return mf.copy(src, space); }); }
+
+inline void ErasedNode::decrement(void * datum) noexcept {
+    const auto & mf = *m_metafunctions;
+    mf.destroy(datum);
+    this->~ErasedNode();
+    NodePool::deallocate(this, block_size(mf));
+}
+
+template <typename Func>
+/* private static */ NodeOwningPtr ErasedNode::make_
+    (const MetaFunctions & mf, Func && construct)
+{
+    assert(mf.object_align() <= alignof(std::max_align_t));
+    auto * block = reinterpret_cast<Byte *>(NodePool::allocate(block_size(mf)));
+    void * datum = nullptr;
+    try {
+        datum = construct(block + datum_offset());
+    } catch (...) {
+        NodePool::deallocate(block, block_size(mf));
+        throw;
+    }
+    assert(datum == block + datum_offset());
+    auto * node = new (block) ErasedNode{datum, mf};
+    NodeInstanceAttn::set_source(node->m_node, node);
+    return NodeOwningPtr{&node->m_node};
+}
+
+// NodePool
+
+/* static */ inline void * NodePool::allocate(Size size) {
+    auto cls = size_class_of(size);
+    auto * lists = free_lists();
+    if (!lists || cls >= k_size_class_count || !lists->heads[cls])
+        { return ::operator new(size); }
+    auto * block = lists->heads[cls];
+    lists->heads[cls] = block->next;
+    --lists->counts[cls];
+    block->~FreeBlock();
+    return block;
+}
+
+/* static */ inline void NodePool::deallocate(void * ptr, Size size) noexcept {
+    auto cls = size_class_of(size);
+    auto * lists = free_lists();
+    if (   !lists || cls >= k_size_class_count
+        || lists->counts[cls] == k_max_free_per_class)
+    { return ::operator delete(ptr); }
+    lists->heads[cls] = new (ptr) FreeBlock{lists->heads[cls]};
+    ++lists->counts[cls];
+}
+
+/* private static */ inline NodePool::FreeLists * NodePool::free_lists() noexcept {
+    if (lists_are_gone()) return nullptr;
+    thread_local FreeLists inst;
+    return &inst;
+}
+
+inline NodePool::FreeLists::~FreeLists() {
+    for (auto * head : heads) {
+        while (head) {
+            auto * next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+    lists_are_gone() = true;
+}
+
 // level 1 helpers (tree node implementations) impl
 
 inline int height_of(NodeInstance * ptr)
@@ -759,13 +1538,4 @@ inline int height_of(NodeInstance * ptr)
 inline int height_of(const NodeOwningPtr & ptr)
     { return ptr ? ptr->height() : 0; }
 
-inline NodeOwningPtr move_ptr(NodeInstance *& ptrref) {
-#   if 0
-    assert(ptrref);
-#   endif
-    auto t = ptrref;
-    ptrref = nullptr;
-    return NodeOwningPtr{t};
-}
-
 } // end of ecs namespace
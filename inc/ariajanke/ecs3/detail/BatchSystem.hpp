@@ -0,0 +1,67 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <type_traits>
+
+#include <ariajanke/ecs3/FunctionTraits.hpp>
+
+namespace ecs {
+
+template <typename T>
+class Span;
+
+template <typename EntityType, typename Kernel, typename ... Types>
+class BatchSystem;
+
+template <typename T>
+struct SpanElement_ {
+    static_assert(!std::is_same_v<T, T>, "batch kernels may only take spans");
+};
+
+template <typename T>
+struct SpanElement_<Span<T>> {
+    using Type = T;
+};
+
+template <typename EntityType, typename Kernel, typename ArgumentList>
+struct BatchSystemFromArguments_;
+
+template <typename EntityType, typename Kernel, typename ... Arguments>
+struct BatchSystemFromArguments_<EntityType, Kernel, TypeList<Arguments...>> {
+    using Type = BatchSystem<EntityType, Kernel, typename SpanElement_<
+        std::remove_cv_t<std::remove_reference_t<Arguments>>>::Type...>;
+};
+
+template <typename EntityType, typename Kernel>
+struct BatchSystemFromKernel_ {
+    using Type = typename BatchSystemFromArguments_
+        <EntityType, Kernel, typename FunctionTraitsOf<Kernel>::ArgumentTypes>::Type;
+};
+
+} // end of ecs namespace
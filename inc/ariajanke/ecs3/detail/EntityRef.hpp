@@ -26,7 +26,9 @@
 
 #pragma once
 
-#include <ariajanke/ecs3/detail/defs.hpp>
+#include <ariajanke/ecs3/defs.hpp>
+
+#include <vector>
 
 namespace ecs {
 
@@ -34,20 +36,89 @@ class EntityBodyBase {
 public:
     EntityBodyBase() {}
 
+    // a copied body is a new entity, and so it is given a new id
+    EntityBodyBase(const EntityBodyBase &): EntityBodyBase() {}
+
     virtual ~EntityBodyBase() {}
 
     void * downcast(Size safety) noexcept;
 
     const void * downcast(Size safety) const noexcept;
 
+    EntityId id() const noexcept { return m_id; }
+
 protected:
 
     virtual const void * downcast_(Size) const noexcept = 0;
+
+private:
+    static EntityId next_id() noexcept;
+
+    EntityId m_id = next_id();
 };
 
 class EntityRefAttn;
 class ConstEntityRef;
 
+/// Describes how much component storage an entity uses (or should be given
+/// up front).
+struct CapacityHint final {
+    CapacityHint() {}
+
+    CapacityHint(Size component_count_, Size component_bytes_):
+        component_count(component_count_),
+        component_bytes(component_bytes_)
+    {}
+
+    Size component_count = 0;
+    Size component_bytes = 0;
+};
+
+enum class ComponentChange { added, removed, removed_all };
+
+/// Records of which components entities gained or lost, by type key. Each
+/// record covers one change from one call, however many types it names: an
+/// add, a remove, or a removal of everything. A committed edit makes up to
+/// two, one for what it removed, then one for what it added. A change that
+/// names no types (other than removing everything) makes no record.
+template <typename EntityType>
+class ComponentChangeLog final {
+public:
+    template <typename ... Types>
+    void push(const EntityType & ent, ComponentChange change, TypeList<Types...>) {
+        if (sizeof...(Types) == 0 && change != ComponentChange::removed_all)
+            return;
+        auto keys_begin = m_keys.size();
+        (m_keys.push_back(MetaFunctions::key_for_type<Types>()), ...);
+        m_records.push_back(Record{ent, change, keys_begin, m_keys.size()});
+    }
+
+    /// @param f called for each record, in the order they were made, with
+    ///          the entity, the change, and a begin/end pair of type keys
+    template <typename Func>
+    void for_each(Func && f) const {
+        for (const auto & record : m_records) {
+            f(record.entity, record.change,
+              m_keys.data() + record.keys_begin, m_keys.data() + record.keys_end);
+        }
+    }
+
+    void clear() {
+        m_records.clear();
+        m_keys.clear();
+    }
+
+private:
+    struct Record final {
+        EntityType entity;
+        ComponentChange change;
+        Size keys_begin, keys_end;
+    };
+
+    std::vector<Record> m_records;
+    std::vector<Size> m_keys;
+};
+
 template <typename EntityType>
 class HomeSceneBase {
 public:
@@ -55,7 +126,31 @@ public:
     virtual void on_create(const EntityType &) = 0;
     virtual void on_deletion_request(const EntityType &) = 0;
 
+    /// @returns how much storage a new entity of this scene is expected to
+    ///          need
+    virtual CapacityHint capacity_hint() const { return CapacityHint{}; }
+
+    /// Records that an entity gained or lost components. This is called on
+    /// every structural change, so it is not virtual, and only costs a branch
+    /// for scenes that do not keep a log.
+    template <typename ... Types>
+    void log_components_change
+        (const EntityType & ent, ComponentChange change, TypeList<Types...> types)
+    { if (m_logs_changes) m_change_log.push(ent, change, types); }
+
     static HomeSceneBase & no_scene();
+
+protected:
+    void start_logging_changes() noexcept { m_logs_changes = true; }
+
+    const ComponentChangeLog<EntityType> & change_log() const noexcept
+        { return m_change_log; }
+
+    void clear_change_log() { m_change_log.clear(); }
+
+private:
+    bool m_logs_changes = false;
+    ComponentChangeLog<EntityType> m_change_log;
 };
 
 template <typename FullEntity>
@@ -237,6 +237,14 @@ public:
         swap(other);
     }
 
+    /// Copies each bucket of "other" into the same position in this map, no
+    /// rehashing is done. This map must be empty, and have as many buckets
+    /// as "other".
+    /// @param f called on each of other's mapped values, returns the value
+    ///          to be mapped in this map
+    template <typename Func>
+    void copy_layout_from(const UnowningHashMap & other, Func && f);
+
     // removes buckets (including empty ones)
     // This renders the map empty
     BucketSpace strip_buckets() {
@@ -437,6 +445,24 @@ template <typename Key, typename T, typename Hash, typename KeyEqual,
 bool MACRO_CLASS_PREFACE::can_fit_another() const noexcept
     { return can_fit_this_many(size() + 1); }
 
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename EmptyKeyMaker>
+template <typename Func>
+void MACRO_CLASS_PREFACE::copy_layout_from
+    (const UnowningHashMap & other, Func && f)
+{
+    assert(empty());
+    assert(bucket_count() == other.bucket_count());
+    for (std::size_t idx = 0; idx != bucket_count(); ++idx) {
+        const auto & theirs = other.bucket_at(idx);
+        if (key_equal{}(theirs.first, EmptyKeyMaker{}())) continue;
+        // size is kept up to date, in case "f" throws
+        bucket_at(idx).second = f(theirs.second);
+        bucket_at(idx).first  = theirs.first;
+        ++m_size;
+    }
+}
+
 template <typename Key, typename T, typename Hash, typename KeyEqual,
           typename EmptyKeyMaker>
 bool MACRO_CLASS_PREFACE::can_fit_this_many(size_type amount) const noexcept
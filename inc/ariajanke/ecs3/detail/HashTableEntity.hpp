@@ -28,7 +28,9 @@
 
 #include <ariajanke/ecs3/defs.hpp>
 #include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/EntityBlueprint.hpp>
 #include <ariajanke/ecs3/detail/HashMap.hpp>
+#include <ariajanke/ecs3/detail/SortedVectorEntity.hpp>
 
 #include <memory>
 
@@ -58,17 +60,54 @@ public:
     template <typename Type, typename ... ArgTypes>
     Type & append(ArgTypes &&... args);
 
+    /// Move constructs a component, of the type the meta functions are for,
+    /// from one that lives elsewhere (which is left to the caller to
+    /// destroy).
+    void append_moved(void * src, const MetaFunctions &);
+
     template <typename Type>
     bool remove();
 
     void remove_all();
 
+    /// Removes all components, and gives back all memory.
+    void release();
+
     template <typename Type>
     Type * get() const;
 
     template <typename ... Types>
     void reserve_for_more(TypeList<Types...>);
 
+    /// reserves space for the given total number of components and bytes
+    void reserve(const CapacityHint &);
+
+    /// Copies every component of another table into this (empty) one. The
+    /// other table's layout is reused as is, so this takes exactly one
+    /// allocation and no rehashing.
+    /// @throws std::runtime_error if any component is not copyable, at
+    ///         which point this table is left empty
+    void copy_from(const HeterogeneousHashTable &);
+
+    /// Default constructs every component of a blueprint into this (empty)
+    /// table. Bucket arrangement is worked out once per blueprint, then
+    /// reused, so no hashing is done.
+    /// @returns a tuple of references to each new component
+    template <typename ... Types>
+    Tuple<Types & ...> emplace_blueprint(const EntityBlueprint<Types...> &);
+
+    CapacityHint capacity_used() const
+        { return CapacityHint{m_table.size(), m_storage.used_space()}; }
+
+    /// Calls f with each component's address, and meta functions, in no
+    /// particular order.
+    template <typename Func>
+    void for_each(Func && f) const;
+
+    /// @returns a counter which is advanced each time a component is
+    ///          destroyed or components are moved to new storage
+    Size generation() const noexcept { return m_generation; }
+
     // detail
 
     struct EmptyKeyMaker final { Size operator () () const { return 0; } };
@@ -105,6 +144,19 @@ public:
 
         static Storage make_new(Size bucket_count, Size for_components);
 
+        /// @returns new storage, with the same number of buckets, and the
+        ///          same component space in use (including lost bytes)
+        static Storage make_same_layout_as(const Storage &);
+
+        /// @returns the address in this storage, at the same offset as
+        ///          "ptr" is in "other"'s component space
+        void * rebase(const Storage & other, const void * ptr) const;
+
+        /// Sets aside the given number of bytes at the start of (empty)
+        /// component space.
+        /// @returns the start of component space
+        void * claim_component_space(Size bytes);
+
         Storage make_new_without_lost() const;
 
         BucketSpace get_bucket_space() const;
@@ -138,6 +190,8 @@ public:
 
         Tuple<Size, void *> available_space_and_start(Size align) const;
 
+        Byte * components_begin() const;
+
         Byte * m_buckets_end = nullptr;
         Byte * m_comps_end = nullptr;
         Byte * m_end = nullptr;
@@ -178,11 +232,28 @@ private:
     template <typename Head, typename ... Types>
     void reserve_for_more_(TypeList<Head, Types...>, Size size, Size align, Size count);
 
+    // a table for blueprint, whose (unconstructed) components are only there
+    // to be rebased on
+    template <typename ... Types>
+    struct BlueprintImage final {
+        BlueprintImage();
+
+        static const BlueprintImage & instance() {
+            static BlueprintImage inst;
+            return inst;
+        }
+
+        Storage storage;
+        ComponentTable table = ComponentTable{BucketSpace{}};
+        void * components = nullptr;
+    };
+
     template <typename ... Types>
     void reserve_for_more_(TypeList<Types...>, Size size, Size align, Size count);
 
     Storage m_storage;
     ComponentTable m_table = ComponentTable{BucketSpace{}};
+    Size m_generation = 0;
 };
 
 class HashTableEntity;
@@ -199,6 +270,29 @@ public:
     explicit HashTableEntityBody(HomeScene * home): Super(home) {}
 
     HeterogeneousHashTable table;
+    /// Components live here, and not in the table, while the entity is
+    /// frozen.
+    SortedComponentArray frozen;
+
+    bool is_frozen() const noexcept { return frozen.size() != 0; }
+
+    template <typename T>
+    T * get() const
+        { return is_frozen() ? frozen.get<T>() : table.get<T>(); }
+
+    Size generation() const noexcept
+        { return table.generation() + frozen.generation(); }
+
+    CapacityHint capacity_used() const
+        { return is_frozen() ? frozen.capacity_used() : table.capacity_used(); }
+
+    /// Moves every component to the frozen array, which is sized exactly,
+    /// and gives back all of the table's memory.
+    void freeze();
+
+    /// Moves every component back to the table.
+    void thaw();
+
 private:
     using Super = EntityBodyIntr<HashTableEntity>;
     const void * downcast_(Size safety_) const noexcept final {
@@ -234,6 +328,25 @@ Type & HeterogeneousHashTable::append(ArgTypes &&... args) {
     return *rv;
 }
 
+inline void HeterogeneousHashTable::append_moved
+    (void * src, const MetaFunctions & mf)
+{
+    if (m_table.find(mf.key()) != m_table.end()) {
+        throw std::runtime_error("");
+    }
+    auto next = [this, &mf]()
+        { return m_storage.next_component_space(mf.object_align(), mf.object_size()); };
+    auto ptr = next();
+    if (!ptr || !m_table.can_fit_another()) {
+        if (ptr) m_storage.mark_lost_bytes(mf.object_size());
+        move_to(Storage::make_new(m_table.bucket_count()*2 + 1,
+                                  m_storage.used_space()*2 + mf.object_size()));
+        assert(m_table.can_fit_another());
+        ptr = next();
+    }
+    m_table.emplace(mf.key(), std::make_tuple(mf.move(src, ptr), &mf));
+}
+
 template <typename Type>
 bool HeterogeneousHashTable::remove() {
     const auto & mf = metafunctions_for<Type>();
@@ -245,6 +358,7 @@ bool HeterogeneousHashTable::remove() {
     m_storage.mark_lost_bytes(mf.object_size());
 
     mf.destroy(std::get<void *>(itr->second));
+    ++m_generation;
     return true;
 }
 
@@ -256,6 +370,12 @@ inline void HeterogeneousHashTable::remove_all() {
     m_storage.wipe_component_space();
     check_to_realloc();
     m_table.clear();
+    ++m_generation;
+}
+
+inline void HeterogeneousHashTable::release() {
+    remove_all();
+    move_to(Storage{});
 }
 
 template <typename Type>
@@ -265,9 +385,92 @@ Type * HeterogeneousHashTable::get() const {
     return reinterpret_cast<Type *>(std::get<void *>(itr->second));
 }
 
+inline void HeterogeneousHashTable::copy_from
+    (const HeterogeneousHashTable & rhs)
+{
+    assert(m_table.empty());
+    if (rhs.m_table.empty()) return;
+    auto new_store = Storage::make_same_layout_as(rhs.m_storage);
+    ComponentTable new_table{new_store.get_bucket_space()};
+    try {
+        new_table.copy_layout_from(rhs.m_table, [&new_store, &rhs] (const auto & value) {
+            auto [ptr, mf] = value;
+            auto copy = mf->copy(ptr, new_store.rebase(rhs.m_storage, ptr));
+            return std::make_tuple(copy, mf);
+        });
+    } catch (...) {
+        for (auto entry : new_table) {
+            auto [ptr, mf] = entry.second;
+            mf->destroy(ptr);
+        }
+        throw;
+    }
+    m_table.swap(new_table);
+    m_storage.swap(new_store);
+    ++m_generation;
+}
+
 template <typename ... Types>
-void HeterogeneousHashTable::reserve_for_more(TypeList<Types...>)
-    { reserve_for_more_(TypeList<Types...>{}, 0, 0, sizeof...(Types)); }
+Tuple<Types & ...> HeterogeneousHashTable::emplace_blueprint
+    (const EntityBlueprint<Types...> &)
+{
+    using Blueprint = EntityBlueprint<Types...>;
+    assert(m_table.empty());
+    const auto & image = BlueprintImage<Types...>::instance();
+    auto new_store = Storage::make_same_layout_as(image.storage);
+    auto * base = reinterpret_cast<Byte *>(
+        new_store.rebase(image.storage, image.components));
+    Size constructed = 0;
+    try {
+        // comma operator is always sequenced left to right
+        ((new (base + Blueprint::template offset_of<Types>()) Types{},
+          ++constructed), ...);
+    } catch (...) {
+        Size idx = 0;
+        ((idx++ < constructed
+          ? metafunctions_for<Types>().destroy(base + Blueprint::template offset_of<Types>())
+          : void()), ...);
+        throw;
+    }
+    ComponentTable new_table{new_store.get_bucket_space()};
+    new_table.copy_layout_from(image.table, [&new_store, &image] (const auto & value) {
+        auto [ptr, mf] = value;
+        return std::make_tuple(new_store.rebase(image.storage, ptr), mf);
+    });
+    m_table.swap(new_table);
+    m_storage.swap(new_store);
+    ++m_generation;
+    return Tuple<Types & ...>{
+        *reinterpret_cast<Types *>(base + Blueprint::template offset_of<Types>())...};
+}
+
+template <typename Func>
+void HeterogeneousHashTable::for_each(Func && f) const {
+    for (auto entry : m_table) {
+        auto [ptr, mf] = entry.second;
+        f(ptr, *mf);
+    }
+}
+
+template <typename ... Types>
+void HeterogeneousHashTable::reserve_for_more(TypeList<Types...>) {
+    // with no types there's no alignment to go by, and nothing to make room
+    // for anyway
+    if constexpr (sizeof...(Types) != 0)
+        { reserve_for_more_(TypeList<Types...>{}, 0, 0, sizeof...(Types)); }
+}
+
+inline void HeterogeneousHashTable::reserve(const CapacityHint & hint) {
+    static constexpr const auto k_max_align = alignof(std::max_align_t);
+    auto used = m_storage.used_space();
+    if (   m_table.can_fit_this_many(hint.component_count)
+        && (   hint.component_bytes <= used
+            || hint.component_bytes - used <= m_storage.available_space(k_max_align)))
+    { return; }
+    move_to(Storage::make_new(
+        std::max(hint.component_count, m_table.size()),
+        std::max(hint.component_bytes, used)));
+}
 
 /* private */ inline void HeterogeneousHashTable::check_to_realloc() {
     bool should_realloc = m_storage.lost_space()*3 > m_storage.total_space();
@@ -290,6 +493,7 @@ void HeterogeneousHashTable::reserve_for_more(TypeList<Types...>)
     }
     m_table.swap(new_table);
     m_storage.swap(new_store);
+    ++m_generation;
 }
 
 template <typename Head, typename ... Types>
@@ -297,8 +501,10 @@ template <typename Head, typename ... Types>
     (TypeList<Head, Types...>, Size size, Size align, Size count)
 {
     assert(!get<Head>());
+    // worst case padding is assumed, so that no following append comes up
+    // short
     reserve_for_more_(
-        TypeList<Types...>{}, size + sizeof(Head),
+        TypeList<Types...>{}, size + sizeof(Head) + alignof(Head) - 1,
         std::max(align, alignof(Head)), count);
 }
 
@@ -306,14 +512,60 @@ template <typename ... Types>
 /* private */ void HeterogeneousHashTable::reserve_for_more_
     (TypeList<Types...>, Size size, Size align, Size count)
 {
-    if (   size  < m_storage.available_space(align)
-        && count < m_table.bucket_count() - m_table.size())
+    if (   size <= m_storage.available_space(align)
+        && m_table.can_fit_this_many(m_table.size() + count))
     { return; }
     move_to(Storage::make_new(
         count + m_table.size(), size + m_storage.used_space()));
 }
 
 
+template <typename ... Types>
+HeterogeneousHashTable::BlueprintImage<Types...>::BlueprintImage():
+    storage(Storage::make_new(sizeof...(Types), EntityBlueprint<Types...>::k_component_bytes)),
+    table(storage.get_bucket_space())
+{
+    using Blueprint = EntityBlueprint<Types...>;
+    components = storage.claim_component_space(Blueprint::k_component_bytes);
+    auto * base = reinterpret_cast<Byte *>(components);
+    (table.emplace(
+        metafunctions_for<Types>().key(),
+        std::make_tuple(base + Blueprint::template offset_of<Types>(),
+                        &metafunctions_for<Types>())), ...);
+}
+
+// --------------------------- HashTableEntityBody ----------------------------
+
+inline void HashTableEntityBody::freeze() {
+    if (is_frozen()) return;
+    // exactly the room needed is made first, laid out in the order that
+    // components are appended; so nothing may fail once components start
+    // moving out of the table, and there's nothing to shrink after
+    CapacityHint hint;
+    table.for_each([&hint] (void *, const MetaFunctions & mf) {
+        ++hint.component_count;
+        hint.component_bytes = SortedComponentArray::packed_size
+            (hint.component_bytes, mf);
+    });
+    frozen.reserve(hint);
+    table.for_each([this] (void * ptr, const MetaFunctions & mf)
+        { frozen.append_moved(ptr, mf); });
+    table.release();
+}
+
+inline void HashTableEntityBody::thaw() {
+    if (!is_frozen()) return;
+    try {
+        table.reserve(frozen.capacity_used());
+        frozen.for_each([this] (Size, void * ptr, const MetaFunctions & mf)
+            { table.append_moved(ptr, mf); });
+    } catch (...) {
+        table.remove_all();
+        throw;
+    }
+    frozen.release();
+}
+
 // --------------------- HeterogeneousHashTable::Storage ----------------------
 
 inline HeterogeneousHashTable::Storage::~Storage() {
@@ -382,6 +634,37 @@ template <typename Func>
     return rv;
 }
 
+/* static */ inline HeterogeneousHashTable::Storage
+    HeterogeneousHashTable::Storage::make_same_layout_as(const Storage & other)
+{
+    auto bucks = other.get_bucket_space();
+    Size bucket_count = reinterpret_cast<TablePair *>(bucks.end)
+        - reinterpret_cast<TablePair *>(bucks.begin);
+    Size in_use = other.m_comps_end - other.components_begin();
+    // make_new takes element count, not bucket count
+    auto rv = make_new(bucket_count / 2, in_use);
+    assert(rv.get_bucket_space().end - rv.get_bucket_space().begin
+           == bucks.end - bucks.begin);
+    rv.m_comps_end = rv.components_begin() + in_use;
+    rv.m_lost      = other.m_lost;
+    return rv;
+}
+
+inline void * HeterogeneousHashTable::Storage::rebase
+    (const Storage & other, const void * ptr) const
+{
+    auto offset = reinterpret_cast<const Byte *>(ptr) - other.components_begin();
+    assert(offset >= 0 && components_begin() + offset <= m_comps_end);
+    return components_begin() + offset;
+}
+
+inline void * HeterogeneousHashTable::Storage::claim_component_space(Size bytes) {
+    assert(m_comps_end == components_begin());
+    assert(Size(m_end - m_comps_end) >= bytes);
+    m_comps_end = components_begin() + bytes;
+    return components_begin();
+}
+
 inline HeterogeneousHashTable::Storage
     HeterogeneousHashTable::Storage::make_new_without_lost() const
 {
@@ -445,12 +728,8 @@ inline void HeterogeneousHashTable::Storage::mark_lost_bytes(Size lost) {
 }
 
 inline Size HeterogeneousHashTable::Storage::used_space() const {
-    auto bs = get_bucket_space();
-    const auto * start = m_storage_space.get()
-        + size_in_max_aligns((bs.end - bs.begin)*sizeof(TablePair))
-          *sizeof(std::max_align_t);
     // need to not get lost in the padding
-    return (m_comps_end - start) - m_lost;
+    return (m_comps_end - components_begin()) - m_lost;
 }
 
 inline void HeterogeneousHashTable::Storage::swap(Storage & rhs) {
@@ -463,8 +742,17 @@ inline void HeterogeneousHashTable::Storage::swap(Storage & rhs) {
 }
 
 inline void HeterogeneousHashTable::Storage::wipe_component_space() {
-    m_comps_end = m_storage_space.get();
+    m_comps_end = components_begin();
     m_lost = 0;
 }
 
+/* private */ inline HeterogeneousHashTable::Byte *
+    HeterogeneousHashTable::Storage::components_begin() const
+{
+    auto bs = get_bucket_space();
+    return m_storage_space.get()
+        + size_in_max_aligns((bs.end - bs.begin)*sizeof(TablePair))
+          *sizeof(std::max_align_t);
+}
+
 } // end of ecs namespace
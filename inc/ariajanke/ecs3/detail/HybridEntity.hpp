@@ -0,0 +1,130 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/defs.hpp>
+#include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/detail/HashTableEntity.hpp>
+#include <ariajanke/ecs3/detail/StaticEntity.hpp>
+
+namespace ecs {
+
+template <typename ... HotTypes>
+class HybridEntity;
+
+template <typename ... HotTypes>
+class HybridEntityBody final : public EntityBodyIntr<HybridEntity<HotTypes...>> {
+public:
+    using Super     = EntityBodyIntr<HybridEntity<HotTypes...>>;
+    using HomeScene = typename Super::HomeScene;
+
+    template <typename T>
+    static constexpr const bool k_is_hot =
+        InlineComponentSlots<HotTypes...>::template k_has_slot_for<T>;
+
+    HybridEntityBody() {}
+
+    HybridEntityBody(const HybridEntityBody & body):
+        Super(body) {}
+
+    explicit HybridEntityBody(HomeScene * home): Super(home) {}
+
+    template <typename T>
+    T * get() const noexcept {
+        if constexpr (k_is_hot<T>) return hot.template get<T>();
+        else return cold.template get<T>();
+    }
+
+    template <typename T, typename ... ArgTypes>
+    T & append(ArgTypes &&... args) {
+        if constexpr (k_is_hot<T>)
+            { return hot.template emplace<T>(std::forward<ArgTypes>(args)...); }
+        else
+            { return cold.template append<T>(std::forward<ArgTypes>(args)...); }
+    }
+
+    template <typename T>
+    bool remove() {
+        if constexpr (k_is_hot<T>) return hot.template remove<T>();
+        else return cold.template remove<T>();
+    }
+
+    void remove_all() {
+        hot.remove_all();
+        cold.remove_all();
+    }
+
+    /// Reserves, in the overflow table, enough so that appending each of the
+    /// given types moves nothing.
+    template <typename ... Types>
+    void reserve_for_more(TypeList<Types...>);
+
+    /// Copies every component of another body into this (empty) one.
+    /// @throws std::runtime_error if any component is not copyable
+    void copy_from(const HybridEntityBody &);
+
+    Size generation() const noexcept
+        { return hot.generation() + cold.generation(); }
+
+    InlineComponentSlots<HotTypes...> hot;
+    HeterogeneousHashTable cold;
+
+private:
+    // only for use in unevaluated contexts
+    template <typename ... Types>
+    static TypeList<Types...> as_type_list(Tuple<Types...>);
+
+    const void * downcast_(Size safety_) const noexcept final {
+        if (safety_ == Super::get_safety()) return this;
+        return nullptr;
+    }
+};
+
+// ----------------------------- HybridEntityBody -----------------------------
+
+template <typename ... HotTypes>
+template <typename ... Types>
+void HybridEntityBody<HotTypes...>::reserve_for_more(TypeList<Types...>) {
+    using ColdTypes = decltype(as_type_list(std::tuple_cat(
+        std::declval<std::conditional_t<k_is_hot<Types>, Tuple<>, Tuple<Types>>>()...)));
+    if constexpr (ColdTypes::k_count != 0)
+        { cold.reserve_for_more(ColdTypes{}); }
+}
+
+template <typename ... HotTypes>
+void HybridEntityBody<HotTypes...>::copy_from(const HybridEntityBody & rhs) {
+    hot.copy_from(rhs.hot);
+    try {
+        cold.copy_from(rhs.cold);
+    } catch (...) {
+        hot.remove_all();
+        throw;
+    }
+}
+
+} // end of ecs namespace
@@ -0,0 +1,167 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include <ariajanke/ecs3/defs.hpp>
+
+namespace ecs {
+
+/// LSD radix sort on entity ids, a byte at a time. Bytes which every id
+/// shares are skipped, so a batch of entities created around the same time
+/// (whose ids differ in their lowest bytes only) take a pass or two.
+///
+/// @param scratch space for moving entities between passes, left empty
+template <typename EntityType>
+void radix_sort_by_id
+    (std::vector<EntityType> & entities, std::vector<EntityType> & scratch)
+{
+    static constexpr const Size k_digit_bits = 8;
+    static constexpr const Size k_radix = Size(1) << k_digit_bits;
+    static constexpr const EntityId k_digit_mask = k_radix - 1;
+    static constexpr const Size k_id_bits = sizeof(EntityId)*8;
+
+    auto by_id = [] (const EntityType & lhs, const EntityType & rhs)
+        { return lhs.id() < rhs.id(); };
+    if (std::is_sorted(entities.begin(), entities.end(), by_id)) return;
+
+    EntityId differing = 0;
+    for (const auto & ent : entities)
+        { differing |= ent.id() ^ entities.front().id(); }
+
+    scratch.resize(entities.size());
+    for (Size shift = 0; shift != k_id_bits; shift += k_digit_bits) {
+        if (((differing >> shift) & k_digit_mask) == 0) continue;
+
+        std::array<Size, k_radix> offsets {};
+        for (const auto & ent : entities)
+            { ++offsets[(ent.id() >> shift) & k_digit_mask]; }
+        Size sum = 0;
+        for (auto & offset : offsets) {
+            auto count = offset;
+            offset = sum;
+            sum += count;
+        }
+        for (auto & ent : entities) {
+            auto & offset = offsets[(ent.id() >> shift) & k_digit_mask];
+            scratch[offset++] = std::move(ent);
+        }
+        entities.swap(scratch);
+    }
+    scratch.clear();
+}
+
+/// The set of a scene's entities which have a component of some one type.
+///
+/// Entities are kept in a vector for iteration, with each one's position
+/// looked up by id, so that inserts and removals take constant time.
+template <typename EntityType>
+class ComponentIndex final {
+public:
+    template <typename T>
+    static ComponentIndex make_for() {
+        return ComponentIndex{MetaFunctions::key_for_type<T>(),
+            [] (const EntityType & ent) { return ent.template has<T>(); }};
+    }
+
+    /// adds or removes the entity, by whether it has this index's component
+    void refresh(const EntityType & ent) {
+        if (m_has(ent)) insert(ent);
+        else            erase(ent);
+    }
+
+    void insert(const EntityType &);
+
+    void erase(const EntityType &);
+
+    void clear() {
+        m_entities.clear();
+        m_positions.clear();
+    }
+
+    Size key() const noexcept { return m_key; }
+
+    const std::vector<EntityType> & entities() const noexcept
+        { return m_entities; }
+
+private:
+    using HasFunc = bool (*)(const EntityType &);
+
+    ComponentIndex(Size key_, HasFunc has_):
+        m_key(key_), m_has(has_) {}
+
+    Size m_key;
+    HasFunc m_has;
+    std::vector<EntityType> m_entities;
+    std::unordered_map<EntityId, Size> m_positions;
+};
+
+/// What a scene needs of its cached views, to keep them current.
+template <typename EntityType>
+class SceneViewBase {
+public:
+    virtual ~SceneViewBase() {}
+
+    /// adds, updates, or drops the entity, by whether it matches the view
+    virtual void refresh(const EntityType &) = 0;
+
+    virtual void erase(const EntityType &) = 0;
+
+    virtual void clear() = 0;
+
+    /// @returns true if any key is for one of the view's component types
+    virtual bool depends_on(const Size * keys_beg, const Size * keys_end) const = 0;
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename EntityType>
+void ComponentIndex<EntityType>::erase(const EntityType & ent) {
+    auto itr = m_positions.find(ent.id());
+    if (itr == m_positions.end()) return;
+    auto pos = itr->second;
+    m_positions.erase(itr);
+    if (pos + 1 != m_entities.size()) {
+        m_entities[pos] = std::move(m_entities.back());
+        m_positions[m_entities[pos].id()] = pos;
+    }
+    m_entities.pop_back();
+}
+
+template <typename EntityType>
+void ComponentIndex<EntityType>::insert(const EntityType & ent) {
+    auto [itr, is_new] = m_positions.try_emplace(ent.id(), m_entities.size());
+    (void)itr;
+    if (is_new) m_entities.push_back(ent);
+}
+
+} // end of ecs namespace
@@ -28,6 +28,9 @@
 
 #include <type_traits>
 #include <utility>
+#include <array>
+#include <algorithm>
+#include <vector>
 
 #include <ariajanke/ecs3/FunctionTraits.hpp>
 
@@ -57,6 +60,49 @@ struct IsAnOptionalType<Optional<T>> : std::true_type {};
 template <typename T>
 using StripOptional = typename StripOpt_<T>::Type;
 
+template <typename T>
+struct Without;
+
+template <typename ... Types>
+struct AnyOf;
+
+// filters are matched on, but carry no component; they only ask whether
+// an entity has components, and never look any up
+template <typename T>
+struct FilterTraits_ {
+    static constexpr const bool k_is_filter = false;
+};
+
+template <typename T>
+struct FilterTraits_<Without<T>> {
+    static constexpr const bool k_is_filter = true;
+
+    template <typename EntityType>
+    static bool passes(const EntityType & ent) noexcept
+        { return !ent.template has<T>(); }
+};
+
+template <typename ... Types>
+struct FilterTraits_<AnyOf<Types...>> {
+    static constexpr const bool k_is_filter = true;
+
+    template <typename EntityType>
+    static bool passes(const EntityType & ent) noexcept
+        { return (ent.template has<Types>() || ...); }
+};
+
+template <typename T>
+using FilterTraitsOf = FilterTraits_<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template <typename T>
+struct IsAFilterType : std::bool_constant<FilterTraitsOf<T>::k_is_filter> {};
+
+template <typename ArgumentSet>
+using FiltersOf = typename ArgumentSet::template Difference<
+    typename ArgumentSet::template RemoveIf<IsAFilterType>>;
+
+struct FilterArgument_ {};
+
 class Uofa_ {
     template <typename ... Types>
     struct UofaImpl_ {
@@ -77,6 +123,39 @@ public:
 template <typename EntityType>
 class SingleSystemBase;
 
+template <typename EntityType>
+class SceneOf;
+
+template <typename T>
+using ComponentOfArgument = std::remove_cv_t<std::remove_reference_t<T>>;
+
+template <typename Func>
+using RequiredComponentsOf = typename FunctionTraitsOf<Func>::ArgumentTypeSet
+    ::template RemoveIf<IsAnOptionalType>
+    ::template RemoveIf<IsAFilterType>
+    ::template Transform<ComponentOfArgument>;
+
+// component types required by every functor, any entity a system operates on
+// must have all of them
+template <typename ... Funcs>
+struct RequiredByAll_ {
+    using Set = cul::TypeSet<>;
+};
+
+template <typename Func>
+struct RequiredByAll_<Func> {
+    using Set = RequiredComponentsOf<Func>;
+};
+
+template <typename Func, typename NextFunc, typename ... Funcs>
+struct RequiredByAll_<Func, NextFunc, Funcs...> {
+    using Head = RequiredComponentsOf<Func>;
+    using Rest = typename RequiredByAll_<NextFunc, Funcs...>::Set;
+    // (intersection)
+    using Set = typename Head::template Difference<
+        typename Head::template Difference<Rest>>;
+};
+
 template <typename ... FullUnionTypes>
 class SingleSystemsGenerator {
 public:
@@ -110,7 +189,7 @@ public:
         // bottom layer needs to know the union type
         SysLayer(OtherFuncs && ...) {}
 
-        void do_mine(const FullUnionTuple &) const {}
+        void do_mine(const EntityType &, const FullUnionTuple &) const {}
     };
 
     template <typename EntityType, typename Func, typename ... OtherFuncs>
@@ -121,7 +200,23 @@ public:
         using Super = SysLayer<EntityType, OtherFuncs...>;
         using Traits = FunctionTraitsOf<Func>;
         using ArgSet = typename Traits::ArgumentTypeSet;
-        using RequiredArguments = typename ArgSet::template RemoveIf<IsAnOptionalType>;
+        using RequiredArguments = typename ArgSet
+            ::template RemoveIf<IsAnOptionalType>
+            ::template RemoveIf<IsAFilterType>;
+        using FilterArguments = FiltersOf<ArgSet>;
+
+        template <typename ... Filters>
+        struct PassesFilters {
+            bool operator () (const EntityType & ent) const noexcept
+                { return (FilterTraitsOf<Filters>::passes(ent) && ...); }
+        };
+
+        template <typename ... Filters>
+        struct PassesFilters<cul::TypeSet<Filters...>> :
+            public PassesFilters<Filters...>
+        {
+            using PassesFilters<Filters...>::operator();
+        };
 
         template <typename ... Types>
         struct HasRequiredTypes {
@@ -155,7 +250,9 @@ public:
         struct Adapter<Head, RemainingTypes...>:
             public Adapter<RemainingTypes...>
         {
-            using OptType = IsAnOptionalType<std::remove_reference_t<Head>>;
+            using OptType = std::conditional_t<
+                IsAFilterType<Head>::value, FilterArgument_,
+                IsAnOptionalType<std::remove_reference_t<Head>>>;
             using HeadPtr = std::add_pointer_t<StripOptional<std::remove_reference_t<Head>>>;
 
             template <typename ... ArgTypes>
@@ -165,6 +262,10 @@ public:
                     get_head(tup, OptType{}));
             }
 
+            static std::remove_cv_t<std::remove_reference_t<Head>> get_head
+                (const FullUnionTuple &, FilterArgument_)
+            { return std::remove_cv_t<std::remove_reference_t<Head>>{}; }
+
             static Head & get_head
                 (const FullUnionTuple & tup, std::false_type)
             { return *std::get<HeadPtr>(tup); }
@@ -189,12 +290,14 @@ public:
 
         // top level needs the intersection from each functor argument types
 
-        void do_mine(const FullUnionTuple & tup) const {
+        void do_mine(const EntityType & ent, const FullUnionTuple & tup) const {
             // what about wittling down here from deriveds?
-            if (HasRequiredTypes<RequiredArguments>{}(tup)) {
+            if (   HasRequiredTypes<RequiredArguments>{}(tup)
+                && PassesFilters<FilterArguments>{}(ent))
+            {
                 Adapter<ArgSet>{}(f, tup);
             }
-            Super::do_mine(tup);
+            Super::do_mine(ent, tup);
         }
 
     private:
@@ -221,17 +324,120 @@ public:
     template <typename EntityType, typename ... Funcs>
     class SingleSystem final : public SysLayer<EntityType, Funcs...> {
         using Super = SysLayer<EntityType, Funcs...>;
-    public:
-        SingleSystem(Funcs && ... funcs):
-            Super(std::forward<Funcs>(funcs)...) {}
 
-        void operate(EntityType & ent) const final {
+        using FullUnionSet = cul::TypeSet<FullUnionTypes...>;
+
+        // looks up one required component, for the tuple handed to functors
+        // @returns false if the entity is without it
+        using Fetch = bool (*)(EntityType &, FullUnionTuple &);
+
+        struct FetchEntry final {
+            // tracked types come first, rarest first, then untracked types,
+            // and lastly the type whose index is visited, which (nearly)
+            // every candidate has
+            int group;
+            Size population;
+            Size key;
+            Fetch fetch;
+
+            bool operator < (const FetchEntry & rhs) const noexcept {
+                return std::make_tuple(group, population) <
+                       std::make_tuple(rhs.group, rhs.population);
+            }
+        };
+
+        template <typename T>
+        static FetchEntry fetch_entry_for
+            (const SceneOf<EntityType> & scene, Size visited_key)
+        {
+            auto key = MetaFunctions::key_for_type<T>();
+            bool tracked = scene.template is_tracking<T>();
+            return FetchEntry{
+                key == visited_key ? 2 : (tracked ? 0 : 1),
+                tracked ? scene.template population_of<T>() : 0,
+                key,
+                [] (EntityType & ent, FullUnionTuple & tup)
+                { return !!(std::get<T *>(tup) = ent.template ptr<T>()); }};
+        }
+
+        template <typename ... Types>
+        static std::array<FetchEntry, sizeof...(Types)> ordered_fetches_
+            (const SceneOf<EntityType> & scene, cul::TypeSet<Types...>)
+        {
+            // (unused if there are no required types)
+            [[maybe_unused]] auto visited_key =
+                scene.template candidates_key<Types...>();
+            std::array<FetchEntry, sizeof...(Types)> rv
+                { fetch_entry_for<Types>(scene, visited_key)... };
+            std::stable_sort(rv.begin(), rv.end());
+            return rv;
+        }
+
+        template <typename ... Types>
+        static void fetch_others_
+            (EntityType & ent, FullUnionTuple & tup, cul::TypeSet<Types...>)
+        { ((std::get<Types *>(tup) = ent.template ptr<Types>()), ...); }
+
+        // Visits only the candidates of the rarest tracked component, and
+        // looks up each component every functor needs in the order above,
+        // passing over an entity at the first one missing. Each component
+        // is looked up just once, what's found is what functors are given.
+        template <typename ... Types>
+        void operate_on_scene_
+            (const SceneOf<EntityType> & scene, cul::TypeSet<Types...> required) const
+        {
+            using Others = typename FullUnionSet::template Difference<cul::TypeSet<Types...>>;
+            auto fetches = ordered_fetches_(scene, required);
+            for (auto ent : scene.template candidates_having<Types...>()) {
+                FullUnionTuple tup{};
+                bool has_required = std::all_of(fetches.begin(), fetches.end(),
+                    [&ent, &tup] (const FetchEntry & entry)
+                    { return entry.fetch(ent, tup); });
+                if (!has_required) continue;
+                fetch_others_(ent, tup, Others{});
+                Super::do_mine(ent, tup);
+            }
+        }
+
+        template <typename ... Types>
+        static std::vector<Size> probe_order_
+            (const SceneOf<EntityType> & scene, cul::TypeSet<Types...> required)
+        {
+            auto fetches = ordered_fetches_(scene, required);
+            std::vector<Size> rv;
+            for (const auto & entry : fetches)
+                { rv.push_back(entry.key); }
+            return rv;
+        }
+
+        void operate_(EntityType & ent) const {
             // intersection reject here?
             // "TypeSet" should not be a type in the full type union! (uh oh)
             // also making a blank system should be possible
             // also should be made to work on a single type
-            Super::do_mine(EntityAdapter<EntityType, FullUnionTypes...>{}(ent));
+            Super::do_mine(ent, EntityAdapter<EntityType, FullUnionTypes...>{}(ent));
         }
+
+    public:
+        SingleSystem(Funcs && ... funcs):
+            Super(std::forward<Funcs>(funcs)...) {}
+
+        /// Same as calling the system on the scene, but without going
+        /// through any virtual call, so functors may be inlined into the
+        /// loop over entities.
+        void run_on(const SceneOf<EntityType> & scene) const
+            { operate_on_scene_(scene, typename RequiredByAll_<Funcs...>::Set{}); }
+
+        /// @returns keys of the component types every functor needs, in
+        ///          the order they're looked up on each entity of the scene
+        std::vector<Size> probe_order(const SceneOf<EntityType> & scene) const
+            { return probe_order_(scene, typename RequiredByAll_<Funcs...>::Set{}); }
+
+        void operate_on_scene(const SceneOf<EntityType> & scene) const final
+            { run_on(scene); }
+
+        void operate(EntityType & ent) const final
+            { operate_(ent); }
     };
 };
 
@@ -244,8 +450,11 @@ using UnionOfFunctorArguments = Uofa_::UnionOfFunctorArguments<Types...>;
 
 template <typename EntityType, typename ... Functors>
 class SinglesSystemFromFunctors_ {
-    using RequiredTypes = typename UnionOfFunctorArguments<Functors...>::template RemoveIf<IsAnOptionalType>;
-    using OptionalTypes = typename UnionOfFunctorArguments<Functors...>::template Difference<RequiredTypes>;
+    using AllArguments  = UnionOfFunctorArguments<Functors...>;
+    using Components    = typename AllArguments::template RemoveIf<IsAFilterType>;
+    using RequiredTypes = typename Components::template RemoveIf<IsAnOptionalType>;
+    using OptionalTypes = typename Components::template Difference<RequiredTypes>;
+    // filtered components are never fetched, filters only test presence
     using FullUnion     = typename OptionalTypes::template Transform<StripOptional>
         ::template Union<
             typename RequiredTypes::template Transform<std::remove_reference_t>
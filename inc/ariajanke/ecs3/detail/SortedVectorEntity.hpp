@@ -0,0 +1,459 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/defs.hpp>
+#include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/EntityBlueprint.hpp>
+
+#include <memory>
+
+namespace ecs {
+
+/** An array of differently, and uniquely typed objects, sorted by type key.
+ *
+ *  Keys, the offsets of their components, and the components themselves all
+ *  share a single allocation. Keys are kept in their own run, so that a
+ *  lookup reads nothing else until the sought key is found.
+ *
+ *  This is meant for entities with few components (about sixteen or less),
+ *  where following pointers around a tree, or through a sparse table, costs
+ *  more than it saves.
+ *
+ *  @warning This class contains a lot of unsafe code.
+ */
+class SortedComponentArray final {
+public:
+    /// Up to this many keys are searched with a linear count (which has no
+    /// branches to mispredict, and is readily vectorized), past which a
+    /// branchless binary search is used instead.
+    static constexpr const Size k_linear_search_limit = 16;
+
+    SortedComponentArray() {}
+
+    SortedComponentArray(const SortedComponentArray &) = delete;
+
+    SortedComponentArray(SortedComponentArray &&) = delete;
+
+    ~SortedComponentArray() { remove_all(); }
+
+    SortedComponentArray & operator = (const SortedComponentArray &) = delete;
+
+    SortedComponentArray & operator = (SortedComponentArray &&) = delete;
+
+    template <typename Type, typename ... ArgTypes>
+    Type & append(ArgTypes &&... args);
+
+    /// Move constructs a component, of the type the meta functions are for,
+    /// from one that lives elsewhere (which is left to the caller to
+    /// destroy).
+    void append_moved(void * src, const MetaFunctions &);
+
+    /// Copy constructs a component, of the type the meta functions are for,
+    /// from one that lives elsewhere.
+    /// @throws std::runtime_error if the type cannot be copied
+    void append_copied(const void * src, const MetaFunctions &);
+
+    template <typename Type>
+    bool remove();
+
+    void remove_all();
+
+    /// Removes all components, and gives back all memory.
+    void release();
+
+    /// Moves every component to an allocation with no room to spare.
+    void shrink_to_fit();
+
+    template <typename Type>
+    Type * get() const
+        { return reinterpret_cast<Type *>(find(MetaFunctions::key_for_type<Type>())); }
+
+    /// @returns the component with the given key, or nullptr if not present
+    void * find(Size key) const noexcept;
+
+    template <typename ... Types>
+    void reserve_for_more(TypeList<Types...>);
+
+    /// reserves space for the given total number of components and bytes
+    void reserve(const CapacityHint &);
+
+    /// @returns bytes used once a component is appended, with no padding
+    ///          beyond what its alignment needs
+    static Size packed_size(Size bytes_used, const MetaFunctions & mf) noexcept
+        { return round_up(bytes_used, mf.object_align()) + mf.object_size(); }
+
+    /// Copies every component of another array into this (empty) one, with
+    /// the same layout, in exactly one allocation.
+    /// @throws std::runtime_error if any component is not copyable, at
+    ///         which point this array is left empty
+    void copy_from(const SortedComponentArray &);
+
+    /// Bytes are counted with worst case padding, so that a hint taken from
+    /// one array is enough for any other with the same components, in
+    /// whatever order they were added.
+    CapacityHint capacity_used() const noexcept
+        { return CapacityHint{m_count, m_padded_bytes}; }
+
+    /// @returns a counter which is advanced each time a component is
+    ///          destroyed or components are moved to new storage
+    Size generation() const noexcept { return m_generation; }
+
+    /// @returns number of components
+    Size size() const noexcept { return m_count; }
+
+    /// Calls f with each component's key, address, and meta functions, in
+    /// key order.
+    template <typename Func>
+    void for_each(Func && f) const;
+
+private:
+    using Byte = std::byte;
+
+    static constexpr const Size k_max_align = alignof(std::max_align_t);
+
+    struct Slot final {
+        Size offset = 0;
+        const MetaFunctions * metafunctions = nullptr;
+    };
+
+    static Size round_up(Size n, Size align) noexcept
+        { return ((n + align - 1) / align)*align; }
+
+    // keys and slots, together, rounded up so that components are max
+    // aligned
+    static Size header_size(Size capacity) noexcept
+        { return round_up(capacity*(sizeof(Size) + sizeof(Slot)), k_max_align); }
+
+    // left uninitialized (unlike make_unique), as every byte used is
+    // written before it's read
+    static std::unique_ptr<Byte[]> allocate_space(Size bytes)
+        { return std::unique_ptr<Byte[]>(new Byte[bytes]); }
+
+    // @returns index of the first key not less than the given one
+    Size lower_bound(Size key) const noexcept;
+
+    Size * keys() const noexcept
+        { return reinterpret_cast<Size *>(m_space.get()); }
+
+    Slot * slots() const noexcept
+        { return reinterpret_cast<Slot *>(m_space.get() + sizeof(Size)*m_capacity); }
+
+    Byte * components() const noexcept
+        { return m_space.get() + header_size(m_capacity); }
+
+    bool can_fit(Size count, Size bytes) const noexcept
+        { return count <= m_capacity && bytes <= m_bytes_capacity; }
+
+    // moves every component, without gaps, to a new allocation with room for
+    // at least the given number of components and bytes
+    void reallocate(Size capacity, Size bytes_capacity);
+
+    // @throws std::runtime_error, with the given message, if a component of
+    //         the same type is present
+    // @returns index where the new key goes, and the offset where its
+    //          component goes, with room made for both
+    Tuple<Size, Size> make_room_for(const MetaFunctions &, const char * already_present);
+
+    // call after constructing a component at a place given by make_room_for
+    void commit_append(Size idx, Size offset, const MetaFunctions &) noexcept;
+
+    void insert_slot(Size idx, Size key, const Slot &) noexcept;
+
+    void erase_slot(Size idx) noexcept;
+
+    std::unique_ptr<Byte[]> m_space;
+    Size m_capacity = 0;
+    Size m_count = 0;
+    Size m_bytes_capacity = 0;
+    // includes bytes lost to removed components
+    Size m_bytes_used = 0;
+    // each living component's size, plus its worst case padding
+    Size m_padded_bytes = 0;
+    Size m_generation = 0;
+};
+
+class SortedVectorEntity;
+
+class SortedVectorEntityBody final : public EntityBodyIntr<SortedVectorEntity> {
+public:
+    SortedVectorEntityBody() {}
+
+    SortedVectorEntityBody(const SortedVectorEntityBody & body):
+        Super(body) {}
+
+    explicit SortedVectorEntityBody(HomeScene * home): Super(home) {}
+
+    SortedComponentArray components;
+
+private:
+    using Super = EntityBodyIntr<SortedVectorEntity>;
+    const void * downcast_(Size safety_) const noexcept final {
+        if (safety_ == get_safety()) return this;
+        return nullptr;
+    }
+};
+
+// --------------------------- SortedComponentArray ---------------------------
+
+template <typename Type, typename ... ArgTypes>
+Type & SortedComponentArray::append(ArgTypes &&... args) {
+    static constexpr auto k_already_present =
+        "SortedComponentArray::append: a component of this type is already "
+        "present.";
+    static_assert(alignof(Type) <= k_max_align,
+                  "Over-aligned components are not supported.");
+    const auto & mf = MetaFunctions::for_type<Type>();
+    auto [idx, offset] = make_room_for(mf, k_already_present); {}
+    auto rv = new (components() + offset) Type(std::forward<ArgTypes>(args)...);
+    commit_append(idx, offset, mf);
+    return *rv;
+}
+
+inline void SortedComponentArray::append_moved
+    (void * src, const MetaFunctions & mf)
+{
+    static constexpr auto k_already_present =
+        "SortedComponentArray::append_moved: a component of this type is "
+        "already present.";
+    assert(mf.object_align() <= k_max_align);
+    auto [idx, offset] = make_room_for(mf, k_already_present); {}
+    mf.move(src, components() + offset);
+    commit_append(idx, offset, mf);
+}
+
+inline void SortedComponentArray::append_copied
+    (const void * src, const MetaFunctions & mf)
+{
+    static constexpr auto k_already_present =
+        "SortedComponentArray::append_copied: a component of this type is "
+        "already present.";
+    assert(mf.object_align() <= k_max_align);
+    auto [idx, offset] = make_room_for(mf, k_already_present); {}
+    mf.copy(src, components() + offset);
+    commit_append(idx, offset, mf);
+}
+
+template <typename Type>
+bool SortedComponentArray::remove() {
+    auto key = MetaFunctions::key_for_type<Type>();
+    auto idx = lower_bound(key);
+    if (idx == m_count || keys()[idx] != key) return false;
+    auto slot = slots()[idx];
+    erase_slot(idx);
+    slot.metafunctions->destroy(components() + slot.offset);
+    m_padded_bytes -= sizeof(Type) + alignof(Type) - 1;
+    // space is only regained when moving to a new allocation, or once empty
+    if (m_count == 0) m_bytes_used = 0;
+    ++m_generation;
+    return true;
+}
+
+inline void SortedComponentArray::remove_all() {
+    for (Size i = 0; i != m_count; ++i)
+        { slots()[i].metafunctions->destroy(components() + slots()[i].offset); }
+    m_count = 0;
+    m_bytes_used = 0;
+    m_padded_bytes = 0;
+    ++m_generation;
+}
+
+inline void SortedComponentArray::release() {
+    remove_all();
+    m_space.reset();
+    m_capacity = m_bytes_capacity = 0;
+}
+
+inline void SortedComponentArray::shrink_to_fit() {
+    // reallocation packs components without gaps, and never gives less
+    // than what they need
+    if (m_count == m_capacity && m_bytes_used == m_bytes_capacity) return;
+    reallocate(m_count, 0);
+}
+
+template <typename ... Types>
+void SortedComponentArray::reserve_for_more(TypeList<Types...>) {
+    // worst case padding is assumed, so that no following append comes up
+    // short
+    static constexpr const Size k_bytes = ((sizeof(Types) + alignof(Types) - 1) + ... + 0);
+    if (can_fit(m_count + sizeof...(Types), m_bytes_used + k_bytes)) return;
+    reallocate(m_count + sizeof...(Types), m_bytes_used + k_bytes);
+}
+
+inline void SortedComponentArray::reserve(const CapacityHint & hint) {
+    if (can_fit(hint.component_count, hint.component_bytes)) return;
+    reallocate(std::max(hint.component_count, m_count),
+               std::max(hint.component_bytes, m_bytes_used));
+}
+
+inline void SortedComponentArray::copy_from(const SortedComponentArray & rhs) {
+    assert(m_count == 0);
+    if (rhs.m_count == 0) return;
+    SortedComponentArray copy;
+    copy.m_space = allocate_space
+        (header_size(rhs.m_capacity) + rhs.m_bytes_capacity);
+    copy.m_capacity       = rhs.m_capacity;
+    copy.m_bytes_capacity = rhs.m_bytes_capacity;
+    copy.m_bytes_used     = rhs.m_bytes_used;
+    copy.m_padded_bytes   = rhs.m_padded_bytes;
+    std::memcpy(copy.keys(), rhs.keys(), sizeof(Size)*rhs.m_count);
+    std::memcpy(copy.slots(), rhs.slots(), sizeof(Slot)*rhs.m_count);
+    // copy's count is only advanced with each successful copy, so that
+    // only those are destroyed if one throws
+    for (; copy.m_count != rhs.m_count; ++copy.m_count) {
+        const auto & slot = rhs.slots()[copy.m_count];
+        slot.metafunctions->copy(rhs.components() + slot.offset,
+                                 copy.components() + slot.offset);
+    }
+    std::swap(m_space         , copy.m_space         );
+    std::swap(m_capacity      , copy.m_capacity      );
+    std::swap(m_count         , copy.m_count         );
+    std::swap(m_bytes_capacity, copy.m_bytes_capacity);
+    std::swap(m_bytes_used    , copy.m_bytes_used    );
+    std::swap(m_padded_bytes  , copy.m_padded_bytes  );
+    ++m_generation;
+}
+
+template <typename Func>
+void SortedComponentArray::for_each(Func && f) const {
+    for (Size i = 0; i != m_count; ++i) {
+        const auto & slot = slots()[i];
+        f(keys()[i], static_cast<void *>(components() + slot.offset),
+          *slot.metafunctions);
+    }
+}
+
+/* private */ inline Size SortedComponentArray::lower_bound(Size key) const noexcept {
+    const auto * keys_ = keys();
+    if (m_count <= k_linear_search_limit) {
+        // no early exit, so there is nothing to mispredict
+        Size rv = 0;
+        for (Size i = 0; i != m_count; ++i)
+            { rv += Size(keys_[i] < key); }
+        return rv;
+    }
+    // the sought position is always within [base, base + len]
+    const auto * base = keys_;
+    Size len = m_count;
+    while (len > 1) {
+        auto half = len / 2;
+        base += (base[half] < key) ? half : 0;
+        len -= half;
+    }
+    return Size(base - keys_) + Size(*base < key);
+}
+
+inline void * SortedComponentArray::find(Size key) const noexcept {
+    auto idx = lower_bound(key);
+    if (idx == m_count || keys()[idx] != key) return nullptr;
+    return components() + slots()[idx].offset;
+}
+
+/* private */ inline void SortedComponentArray::reallocate
+    (Size capacity, Size bytes_capacity)
+{
+    assert(capacity >= m_count);
+    Size live_bytes = 0;
+    for (Size i = 0; i != m_count; ++i) {
+        const auto & mf = *slots()[i].metafunctions;
+        live_bytes = packed_size(live_bytes, mf);
+    }
+    bytes_capacity = std::max(bytes_capacity, live_bytes);
+
+    auto new_space = allocate_space(header_size(capacity) + bytes_capacity);
+    auto * new_keys  = reinterpret_cast<Size *>(new_space.get());
+    auto * new_slots = reinterpret_cast<Slot *>(new_space.get() + sizeof(Size)*capacity);
+    auto * new_comps = new_space.get() + header_size(capacity);
+    Size offset = 0;
+    for (Size i = 0; i != m_count; ++i) {
+        const auto & slot = slots()[i];
+        const auto & mf = *slot.metafunctions;
+        offset = round_up(offset, mf.object_align());
+        auto * old_comp = components() + slot.offset;
+        mf.move(old_comp, new_comps + offset);
+        mf.destroy(old_comp);
+        new_keys [i] = keys()[i];
+        new_slots[i] = Slot{offset, &mf};
+        offset += mf.object_size();
+    }
+    m_space          = std::move(new_space);
+    m_capacity       = capacity;
+    m_bytes_capacity = bytes_capacity;
+    m_bytes_used     = offset;
+    ++m_generation;
+}
+
+/* private */ inline Tuple<Size, Size> SortedComponentArray::make_room_for
+    (const MetaFunctions & mf, const char * already_present)
+{
+    auto key = mf.key();
+    auto idx = lower_bound(key);
+    if (idx != m_count && keys()[idx] == key)
+        { throw RtError(already_present); }
+    auto size   = mf.object_size();
+    auto align  = mf.object_align();
+    auto offset = round_up(m_bytes_used, align);
+    if (!can_fit(m_count + 1, offset + size)) {
+        reallocate(std::max(m_count + 1, m_capacity*2),
+                   std::max(m_bytes_used + size + align - 1, m_bytes_capacity*2));
+        offset = round_up(m_bytes_used, align);
+    }
+    return std::make_tuple(idx, offset);
+}
+
+/* private */ inline void SortedComponentArray::commit_append
+    (Size idx, Size offset, const MetaFunctions & mf) noexcept
+{
+    insert_slot(idx, mf.key(), Slot{offset, &mf});
+    m_bytes_used = offset + mf.object_size();
+    m_padded_bytes += mf.object_size() + mf.object_align() - 1;
+}
+
+/* private */ inline void SortedComponentArray::insert_slot
+    (Size idx, Size key, const Slot & slot) noexcept
+{
+    assert(m_count < m_capacity && idx <= m_count);
+    auto * keys_  = keys();
+    auto * slots_ = slots();
+    std::memmove(keys_  + idx + 1, keys_  + idx, sizeof(Size)*(m_count - idx));
+    std::memmove(slots_ + idx + 1, slots_ + idx, sizeof(Slot)*(m_count - idx));
+    keys_ [idx] = key;
+    slots_[idx] = slot;
+    ++m_count;
+}
+
+/* private */ inline void SortedComponentArray::erase_slot(Size idx) noexcept {
+    assert(idx < m_count);
+    auto * keys_  = keys();
+    auto * slots_ = slots();
+    std::memmove(keys_  + idx, keys_  + idx + 1, sizeof(Size)*(m_count - idx - 1));
+    std::memmove(slots_ + idx, slots_ + idx + 1, sizeof(Slot)*(m_count - idx - 1));
+    --m_count;
+}
+
+} // end of ecs namespace
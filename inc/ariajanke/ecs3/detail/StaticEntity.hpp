@@ -0,0 +1,204 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <ariajanke/ecs3/defs.hpp>
+#include <ariajanke/ecs3/EntityRef.hpp>
+
+#include <bitset>
+
+namespace ecs {
+
+/** A fixed slot for each of the given component types, along with a bit
+ *  telling whether the slot holds a component.
+ *
+ *  Where each type lives is known at compile time, so finding a component
+ *  is a test of one bit (and nothing at all for types without a slot).
+ */
+template <typename ... Types>
+class InlineComponentSlots final {
+public:
+    template <typename T>
+    static constexpr const bool k_has_slot_for = (std::is_same_v<T, Types> || ...);
+
+    template <typename T>
+    static constexpr const Size k_count_of = (Size(std::is_same_v<T, Types>) + ... + 0);
+
+    static_assert(((k_count_of<Types> == 1) && ...),
+                  "Each type may only have one slot.");
+
+    InlineComponentSlots() {}
+
+    InlineComponentSlots(const InlineComponentSlots &) = delete;
+
+    InlineComponentSlots(InlineComponentSlots &&) = delete;
+
+    ~InlineComponentSlots() { remove_all(); }
+
+    InlineComponentSlots & operator = (const InlineComponentSlots &) = delete;
+
+    InlineComponentSlots & operator = (InlineComponentSlots &&) = delete;
+
+    /// @throws std::runtime_error if a component of this type is present
+    template <typename T, typename ... ArgTypes>
+    T & emplace(ArgTypes &&... args);
+
+    template <typename T>
+    bool remove();
+
+    void remove_all() noexcept;
+
+    /// @returns the component, or nullptr if it's not present (which is
+    ///          always so for types without a slot)
+    template <typename T>
+    T * get() const noexcept;
+
+    /// Copies every component of another set of slots into these (empty)
+    /// ones.
+    /// @throws std::runtime_error if any component is not copyable, at
+    ///         which point these slots are left empty
+    void copy_from(const InlineComponentSlots &);
+
+    /// @returns number of components present
+    Size size() const noexcept { return m_present.count(); }
+
+    /// @returns a counter which is advanced each time a component is
+    ///          destroyed (components never move)
+    Size generation() const noexcept { return m_generation; }
+
+private:
+    template <typename T>
+    static constexpr Size index_of() noexcept {
+        Size idx = 0;
+        (void)((!std::is_same_v<T, Types> && ++idx) && ...);
+        return idx;
+    }
+
+    template <typename T>
+    void * slot_for() const noexcept {
+        return const_cast<StorageFor<T> *>(
+            &std::get<index_of<T>()>(m_slots));
+    }
+
+    Tuple<StorageFor<Types>...> m_slots;
+    std::bitset<sizeof...(Types)> m_present;
+    Size m_generation = 0;
+};
+
+template <typename ... Types>
+class StaticEntity;
+
+template <typename ... Types>
+class StaticEntityBody final : public EntityBodyIntr<StaticEntity<Types...>> {
+public:
+    using Super     = EntityBodyIntr<StaticEntity<Types...>>;
+    using HomeScene = typename Super::HomeScene;
+
+    StaticEntityBody() {}
+
+    StaticEntityBody(const StaticEntityBody & body):
+        Super(body) {}
+
+    explicit StaticEntityBody(HomeScene * home): Super(home) {}
+
+    InlineComponentSlots<Types...> slots;
+
+private:
+    const void * downcast_(Size safety_) const noexcept final {
+        if (safety_ == Super::get_safety()) return this;
+        return nullptr;
+    }
+};
+
+// --------------------------- InlineComponentSlots ---------------------------
+
+template <typename ... Types>
+template <typename T, typename ... ArgTypes>
+T & InlineComponentSlots<Types...>::emplace(ArgTypes &&... args) {
+    static constexpr auto k_already_present =
+        "InlineComponentSlots::emplace: a component of this type is already "
+        "present.";
+    static_assert(k_has_slot_for<T>, "There is no slot for this type.");
+    if (m_present.test(index_of<T>()))
+        { throw RtError(k_already_present); }
+    auto rv = new (slot_for<T>()) T(std::forward<ArgTypes>(args)...);
+    m_present.set(index_of<T>());
+    return *rv;
+}
+
+template <typename ... Types>
+template <typename T>
+bool InlineComponentSlots<Types...>::remove() {
+    static_assert(k_has_slot_for<T>, "There is no slot for this type.");
+    if (!m_present.test(index_of<T>())) return false;
+    m_present.reset(index_of<T>());
+    reinterpret_cast<T *>(slot_for<T>())->~T();
+    ++m_generation;
+    return true;
+}
+
+template <typename ... Types>
+void InlineComponentSlots<Types...>::remove_all() noexcept {
+    if (m_present.none()) return;
+    ((m_present.test(index_of<Types>())
+      ? reinterpret_cast<Types *>(slot_for<Types>())->~Types()
+      : void()), ...);
+    m_present.reset();
+    ++m_generation;
+}
+
+template <typename ... Types>
+template <typename T>
+T * InlineComponentSlots<Types...>::get() const noexcept {
+    if constexpr (k_has_slot_for<T>) {
+        if (!m_present.test(index_of<T>())) return nullptr;
+        return reinterpret_cast<T *>(slot_for<T>());
+    } else {
+        return nullptr;
+    }
+}
+
+template <typename ... Types>
+void InlineComponentSlots<Types...>::copy_from
+    (const InlineComponentSlots & rhs)
+{
+    assert(m_present.none());
+    try {
+        // comma operator is always sequenced left to right
+        ((rhs.m_present.test(index_of<Types>())
+          ? (void)(MetaFunctions::for_type<Types>().copy(
+                rhs.slot_for<Types>(), slot_for<Types>()),
+                   m_present.set(index_of<Types>()))
+          : void()), ...);
+    } catch (...) {
+        remove_all();
+        throw;
+    }
+}
+
+} // end of ecs namespace
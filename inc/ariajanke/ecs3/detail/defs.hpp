@@ -28,6 +28,8 @@
 
 #include <ariajanke/cul/Util.hpp>
 
+#include <cstdint>
+
 /** @file details/defs.hpp
  *  Detail files receive very little documentation if any, as they are not 
  *  part of the interface.
@@ -48,4 +50,8 @@ class StorageFor final {
 
 using Size = std::size_t;
 
+/// Every entity is given an id when it is created, one greater than the last
+/// one given. Ids are never reused, and zero is never given to an entity.
+using EntityId = std::uint64_t;
+
 } // end of ecs namespace
@@ -31,7 +31,13 @@
 #pragma once
 
 #include <ariajanke/ecs3/defs.hpp>
+#include <ariajanke/ecs3/EntityBlueprint.hpp>
 #include <ariajanke/ecs3/HashTableEntity.hpp>
 #include <ariajanke/ecs3/AvlTreeEntity.hpp>
+#include <ariajanke/ecs3/SortedVectorEntity.hpp>
+#include <ariajanke/ecs3/AdaptiveEntity.hpp>
+#include <ariajanke/ecs3/StaticEntity.hpp>
+#include <ariajanke/ecs3/HybridEntity.hpp>
 #include <ariajanke/ecs3/Scene.hpp>
 #include <ariajanke/ecs3/SingleSystem.hpp>
+#include <ariajanke/ecs3/BatchSystem.hpp>
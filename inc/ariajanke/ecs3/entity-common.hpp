@@ -28,6 +28,7 @@
 
 #include <ariajanke/ecs3/defs.hpp>
 #include <ariajanke/ecs3/EntityRef.hpp>
+#include <ariajanke/ecs3/EntityBlueprint.hpp>
 
 /// @file entity-common.hpp
 /// Each class here defines common methods for entity types.
@@ -42,6 +43,7 @@ namespace ecs {
 /// - const Type * cptr_<Type>() const noexcept
 /// - bool is_null_() const noexcept
 /// - WeakPtr<const EntityBodyBase> as_weak_cptr_() const noexcept
+/// - Size storage_generation_() const noexcept
 template <typename FullEntity>
 class ConstEntityBase {
 public:
@@ -107,6 +109,12 @@ public:
     ///          messing with tests for equality
     explicit operator bool () const noexcept { return !is_null(); }
 
+    /// @returns a number which changes whenever any previously returned
+    ///          component pointer/reference may have been invalidated (that
+    ///          is when components are removed, or storage is reallocated)
+    Size storage_generation() const noexcept
+        { return static_cast<const FullEntity *>(this)->storage_generation_(); }
+
 #   ifndef DOXYGEN_SHOULD_SKIP_THIS
 protected:
     template <typename ... Types>
@@ -124,7 +132,7 @@ private:
     Tuple<const Head &, const Types & ...> get_impl_(TypeList<Head, Types...>) const;
 
     template <typename ... Types>
-    bool has_any_(TypeList<Types...>) const noexcept { return true; }
+    bool has_any_(TypeList<Types...>) const noexcept { return false; }
 
     template <typename T, typename ... Types>
     bool has_any_(TypeList<T, Types...>) const noexcept;
@@ -138,6 +146,109 @@ private:
 #   endif
 };
 
+/// Caches where a component lives for one particular entity.
+///
+/// Repeated lookups of the same component (say once a frame) cost a single
+/// comparison of the entity's storage generation. A full lookup is only done
+/// if the entity's storage has changed in a way that may have moved or
+/// destroyed the component.
+template <typename T, typename EntityType>
+class ComponentHandle final {
+public:
+    ComponentHandle() {}
+
+    explicit ComponentHandle(const EntityType & entity): m_entity(entity) {}
+
+    /// @returns a pointer to the component, or a nullptr if the entity does
+    ///          not (presently) have the component
+    T * ptr();
+
+    /// @returns a reference to the component
+    /// @throws std::runtime_error if the entity has no such component
+    T & get();
+
+    /// @returns the entity this handle refers to
+    const EntityType & entity() const noexcept { return m_entity; }
+
+private:
+    EntityType m_entity;
+    T * m_ptr = nullptr;
+    Size m_generation = 0;
+};
+
+/// A single component addition recorded by an EntityEditor, along with the
+/// arguments for its constructor.
+template <typename T, typename ... ArgTypes>
+struct EditAdd final {
+    using Type = T;
+
+    Tuple<ArgTypes...> arguments;
+};
+
+/// Records a set of component removals and additions for one entity, which
+/// are then applied all at once on commit.
+///
+/// Applying them all at once allows the entity to size its storage once, no
+/// matter how many components are changed.
+///
+/// Each call returns a new editor (of a new type) which must be chained as an
+/// rvalue. For example:
+/// @code
+/// auto [vel, sprite] = entity.edit().
+///     remove<Idle>().
+///     add<Velocity>(1.f, 0.f).
+///     add<Sprite>().
+///     commit();
+/// @endcode
+template <typename FullEntity, typename RemoveList = TypeList<>, typename ... Adds>
+class EntityEditor;
+
+template <typename FullEntity, typename ... Removes, typename ... Adds>
+class EntityEditor<FullEntity, TypeList<Removes...>, Adds...> final {
+public:
+    using AddedReferences = Tuple<typename Adds::Type & ...>;
+
+    explicit EntityEditor(EntityBase<FullEntity> & entity):
+        m_entity(&entity) {}
+
+    EntityEditor(EntityBase<FullEntity> & entity, Tuple<Adds...> && adds):
+        m_entity(&entity), m_adds(std::move(adds)) {}
+
+    /// Records a component to add, constructed with the given arguments.
+    /// Arguments are copied (or moved) into the editor until commit.
+    template <typename T, typename ... ArgTypes>
+    EntityEditor<FullEntity, TypeList<Removes...>, Adds..., EditAdd<T, std::decay_t<ArgTypes>...>>
+        add(ArgTypes && ... args) &&;
+
+    /// Records components to remove.
+    template <typename T, typename ... FurtherTypes>
+    EntityEditor<FullEntity, TypeList<Removes..., T, FurtherTypes...>, Adds...>
+        remove() &&
+    { return EntityEditor<FullEntity, TypeList<Removes..., T, FurtherTypes...>, Adds...>{*m_entity, std::move(m_adds)}; }
+
+    /// Applies all removes, then all adds (in the order they were given).
+    /// @throws std::runtime_error if a component to remove is missing, or a
+    ///         component to add is already present (and not also being
+    ///         removed), at which point nothing is changed
+    /// @throws any exception thrown by a component's constructor, at which
+    ///         point any component this edit added is removed again (removed
+    ///         components are <em>not</em> restored)
+    /// @returns a tuple of writable references to each newly added component
+    AddedReferences commit() &&;
+
+private:
+    template <typename T, typename ... Types>
+    static constexpr int k_count_of = (int(std::is_same_v<T, Types>) + ... + 0);
+
+    static_assert(((k_count_of<Removes, Removes...> == 1) && ...),
+                  "Each component type may only be removed once per edit.");
+    static_assert(((k_count_of<typename Adds::Type, typename Adds::Type...> == 1) && ...),
+                  "Each component type may only be added once per edit.");
+
+    EntityBase<FullEntity> * m_entity;
+    Tuple<Adds...> m_adds;
+};
+
 /// Helps define method overloads for various public methods of a writable
 /// entity type.
 ///
@@ -148,6 +259,14 @@ private:
 /// - Tuple<Types * ...> ptr_(TypeList<Types...>) noexcept
 /// - T & add_with_args_(ArgTypes &&... args)
 /// - Tuple<Types & ...> add_<Types...>(TypeList<Types...>)
+/// - Size storage_generation_() const noexcept
+/// - void reserve_capacity_(const CapacityHint &)
+/// - CapacityHint capacity_used_() const noexcept
+/// - Tuple<Types & ...> add_blueprint_(const EntityBlueprint<Types...> &)
+/// - void prepare_edit_(TypeList<Removes...>, TypeList<Adds...>)
+///   removes all given types, and readies the entity for all of the adds
+/// - void log_components_change_(ComponentChange, TypeList<Types...>) const
+///   passes the change on to the entity's home scene
 ///
 /// This is usually done by making this class a friend of the derived class,
 /// and then adding the methods as private methods. @n
@@ -157,11 +276,16 @@ private:
 /// require them. They are still required to count as a "full" Entity class.
 /// - static EntityType make_sceneless_entity()
 /// - EntityType make_entity()
+/// - EntityType clone() const
+/// - EntityType clone_sceneless() const
 /// - void request_deletion()
 /// - auto as_const() const
 /// - void swap(EntityType &)
 /// - Size hash() const noexcept
+/// - EntityId id() const noexcept
 /// - void set_home_scene(HomeScene &)
+/// - void set_scene_index(Size)
+/// - Size scene_index() const noexcept
 /// Further is must be copyable, movable, equality comparable, and be
 /// constructed from EntityRefs.
 template <typename FullEntity>
@@ -200,12 +324,37 @@ public:
     template <typename T, typename U, typename ... FurtherTypes>
     Tuple<T &, U &, FurtherTypes & ...> add();
 
+    /// Adds every component of a blueprint, each default constructed
+    /// @note implementations may lay out an entity with no components exactly
+    ///       as the blueprint describes, in one allocation
+    /// @note if an exception is thrown no component is added to the entity
+    /// @throws std::runtime_error if a component of any blueprint type is
+    ///         already present
+    /// @returns a tuple of writable references to each newly added component
+    template <typename ... Types>
+    Tuple<Types & ...> add(const EntityBlueprint<Types...> &);
+
     /// @returns a EntityRef from this entity
     /// @note It is preferred that the client use EntityRef's constructor,
     ///       however there is no reason to restrict it.
     EntityRef as_reference() const noexcept
         { return EntityRef{ static_cast<const FullEntity *>(this)->as_weak_ptr_() }; }
 
+    // -------------------------------- handle --------------------------------
+
+    /// @returns a handle which caches the location of the given component
+    ///          type on this entity
+    template <typename T>
+    ComponentHandle<T, FullEntity> handle() const
+        { return ComponentHandle<T, FullEntity>{*static_cast<const FullEntity *>(this)}; }
+
+    // --------------------------------- edit ---------------------------------
+
+    /// @returns an editor, which records several adds and removes to be
+    ///          applied together
+    EntityEditor<FullEntity> edit()
+        { return EntityEditor<FullEntity>{*this}; }
+
     // -------------------------------- ensure --------------------------------
 
     /// Adds a component if not already present, then "get"s it
@@ -229,6 +378,19 @@ public:
     Tuple<T &, U &, FurtherTypes & ...> ensure()
         { return ensure_impl_(TypeList<T, U, FurtherTypes...>{}); }
 
+    // ------------------------------- capacity -------------------------------
+
+    /// Prepares space for (at least) as many components/bytes as given by the
+    /// hint, so that adding them later does not need to reallocate.
+    /// @note implementations which cannot reserve space will ignore the hint
+    void reserve_capacity(const CapacityHint & hint)
+        { as_fe().reserve_capacity_(hint); }
+
+    /// @returns how many components, and how many bytes for components, this
+    ///          entity presently uses
+    CapacityHint capacity_used() const noexcept
+        { return as_fe().capacity_used_(); }
+
     // ---------------------------------- get ---------------------------------
 
     using ConstEntityBase<FullEntity>::get;
@@ -272,6 +434,9 @@ public:
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 private:
+    template <typename, typename, typename ...>
+    friend class EntityEditor;
+
     template <typename ... Types>
     void check_new_types(TypeList<Types...>) {}
 
@@ -325,8 +490,11 @@ private:
 
         template <typename ... CollectedTypes>
         void operator () (EntityBase<FullEntity> & base, TypeList<CollectedTypes...>) const {
+            if constexpr (sizeof...(CollectedTypes) == 0) return;
             (void)static_cast<FullEntity &>(base).
                 template add_<CollectedTypes...>(TypeList<CollectedTypes...>{});
+            base.as_fe().log_components_change_
+                (ComponentChange::added, TypeList<CollectedTypes...>{});
         }
     };
 
@@ -355,11 +523,28 @@ private:
         return get_impl_(TypeList<Head, FurtherTypes...>{});
     }
 
+    // edit
+
+    template <typename ... Removes, typename ... Adds>
+    Tuple<typename Adds::Type & ...> commit_edit_
+        (TypeList<Removes...>, Tuple<Adds...> && adds);
+
+    template <typename Add>
+    typename Add::Type & apply_edit_add_(Add && add, Size & added_count);
+
+    template <typename ... Adds>
+    void undo_edit_adds_(TypeList<Adds...>, Size added_count) noexcept;
+
+    template <typename T, typename ... Types>
+    static constexpr bool k_is_one_of = (std::is_same_v<T, Types> || ...);
+
     template <typename ... Types>
     void remove_() {
         if (ConstEntityBase<FullEntity>::has_all_(TypeList<Types...>{})) {
-            return static_cast<FullEntity *>(this)->
+            static_cast<FullEntity *>(this)->
                 template remove_<Types...>(TypeList<Types...>{});
+            return as_fe().log_components_change_
+                (ComponentChange::removed, TypeList<Types...>{});
         }
         throw RtError("");
     }
@@ -405,7 +590,7 @@ template <typename T, typename ... Types>
     (TypeList<T, Types...>) const noexcept
 {
     return    static_cast<const FullEntity *>(this)->template cptr_<T>()
-           || has_all_(TypeList<Types...>{});
+           || has_any_(TypeList<Types...>{});
 }
 
 template <typename FullEntity>
@@ -419,27 +604,157 @@ template <typename Head, typename ... Types>
     return tuple_cat(make_tuple(ptr), ptr_impl_(TypeList<Types...>{}));
 }
 
+// --- ComponentHandle ---
+
+template <typename T, typename EntityType>
+T * ComponentHandle<T, EntityType>::ptr() {
+    if (m_entity.is_null()) return nullptr;
+    auto generation = m_entity.storage_generation();
+    if (m_ptr && m_generation == generation) return m_ptr;
+    m_ptr = m_entity.template ptr<T>();
+    m_generation = generation;
+    return m_ptr;
+}
+
+template <typename T, typename EntityType>
+T & ComponentHandle<T, EntityType>::get() {
+    static constexpr auto k_cannot_get_missing =
+        "ComponentHandle::get: cannot get missing component.";
+    auto * rv = ptr();
+    if (rv) return *rv;
+    throw RtError(k_cannot_get_missing);
+}
+
+// --- EntityEditor ---
+
+template <typename FullEntity, typename ... Removes, typename ... Adds>
+template <typename T, typename ... ArgTypes>
+EntityEditor<FullEntity, TypeList<Removes...>, Adds..., EditAdd<T, std::decay_t<ArgTypes>...>>
+    EntityEditor<FullEntity, TypeList<Removes...>, Adds...>::add(ArgTypes && ... args) &&
+{
+    using NewAdd = EditAdd<T, std::decay_t<ArgTypes>...>;
+    using std::tuple_cat, std::make_tuple, std::move;
+    return EntityEditor<FullEntity, TypeList<Removes...>, Adds..., NewAdd>{
+        *m_entity,
+        tuple_cat(move(m_adds),
+                  make_tuple(NewAdd{Tuple<std::decay_t<ArgTypes>...>{
+                      std::forward<ArgTypes>(args)...}}))};
+}
+
+template <typename FullEntity, typename ... Removes, typename ... Adds>
+typename EntityEditor<FullEntity, TypeList<Removes...>, Adds...>::AddedReferences
+    EntityEditor<FullEntity, TypeList<Removes...>, Adds...>::commit() &&
+    { return m_entity->commit_edit_(TypeList<Removes...>{}, std::move(m_adds)); }
+
 // --- EntityBase ---
 
 template <typename FullEntity>
 template <typename T>
 T & EntityBase<FullEntity>::add() {
     check_new_types(TypeList<T>{});
-    return std::get<0>(as_fe().template add_<T>(TypeList<T>{}));
+    auto & rv = std::get<0>(as_fe().template add_<T>(TypeList<T>{}));
+    as_fe().log_components_change_(ComponentChange::added, TypeList<T>{});
+    return rv;
 }
 
 template <typename FullEntity>
 template <typename T, typename ... ArgTypes>
 T & EntityBase<FullEntity>::add(ArgTypes && ... args) {
     check_new_types(TypeList<T>{});
-    return as_fe().template add_with_args_<T>(std::forward<ArgTypes>(args)...);
+    auto & rv = as_fe().template add_with_args_<T>(std::forward<ArgTypes>(args)...);
+    as_fe().log_components_change_(ComponentChange::added, TypeList<T>{});
+    return rv;
 }
 
 template <typename FullEntity>
 template <typename T, typename U, typename ... FurtherTypes>
 Tuple<T &, U &, FurtherTypes & ...> EntityBase<FullEntity>::add() {
     check_new_types(TypeList<T, U, FurtherTypes...>{});
-    return as_fe().template add_<T, U, FurtherTypes...>(TypeList<T, U, FurtherTypes...>{});
+    auto rv = as_fe().template add_<T, U, FurtherTypes...>(TypeList<T, U, FurtherTypes...>{});
+    as_fe().log_components_change_
+        (ComponentChange::added, TypeList<T, U, FurtherTypes...>{});
+    return rv;
+}
+
+template <typename FullEntity>
+template <typename ... Removes, typename ... Adds>
+/* private */ Tuple<typename Adds::Type & ...> EntityBase<FullEntity>::commit_edit_
+    (TypeList<Removes...>, Tuple<Adds...> && adds)
+{
+    static constexpr auto k_missing_remove =
+        "EntityBase::edit: cannot remove a missing component.";
+    static constexpr auto k_present_add =
+        "EntityBase::edit: cannot add a component which is already present.";
+    using AddTypes = TypeList<typename Adds::Type...>;
+    if (!ConstEntityBase<FullEntity>::has_all_(TypeList<Removes...>{})) {
+        throw RtError(k_missing_remove);
+    }
+    bool adds_are_new =
+        (   (   k_is_one_of<typename Adds::Type, Removes...>
+             || !as_fe().template cptr_<typename Adds::Type>())
+         && ...);
+    if (!adds_are_new) {
+        throw RtError(k_present_add);
+    }
+    check_new_types(AddTypes{});
+    as_fe().prepare_edit_(TypeList<Removes...>{}, AddTypes{});
+
+    Size added_count = 0;
+    try {
+        // braced initialization guarantees left to right evaluation
+        Tuple<typename Adds::Type & ...> rv{
+            apply_edit_add_(std::move(std::get<Adds>(adds)), added_count)...};
+        // two records, removes first (an empty side is not logged)
+        as_fe().log_components_change_(ComponentChange::removed, TypeList<Removes...>{});
+        as_fe().log_components_change_(ComponentChange::added, AddTypes{});
+        return rv;
+    } catch (...) {
+        undo_edit_adds_(AddTypes{}, added_count);
+        // removes have still been made
+        as_fe().log_components_change_(ComponentChange::removed, TypeList<Removes...>{});
+        throw;
+    }
+}
+
+template <typename FullEntity>
+template <typename Add>
+/* private */ typename Add::Type & EntityBase<FullEntity>::apply_edit_add_
+    (Add && add, Size & added_count)
+{
+    auto & rv = std::apply([this] (auto && ... args) -> typename Add::Type & {
+        return as_fe().template add_with_args_<typename Add::Type>(std::move(args)...);
+    }, std::move(add.arguments));
+    ++added_count;
+    return rv;
+}
+
+template <typename FullEntity>
+template <typename ... Adds>
+/* private */ void EntityBase<FullEntity>::undo_edit_adds_
+    (TypeList<Adds...>, Size added_count) noexcept
+{
+    Size idx = 0;
+    ((idx++ < added_count ? as_fe().remove_(TypeList<Adds>{}) : void()), ...);
+}
+
+template <typename FullEntity>
+template <typename ... Types>
+Tuple<Types & ...> EntityBase<FullEntity>::add
+    (const EntityBlueprint<Types...> & blueprint)
+{
+    static constexpr auto k_already_present =
+        "EntityBase::add: cannot add blueprint, a component is already present.";
+    if constexpr (sizeof...(Types) == 0) {
+        return Tuple<>{};
+    } else {
+        if ((this->template has<Types>() || ...)) {
+            throw RtError(k_already_present);
+        }
+        check_new_types(TypeList<Types...>{});
+        auto rv = as_fe().add_blueprint_(blueprint);
+        as_fe().log_components_change_(ComponentChange::added, TypeList<Types...>{});
+        return rv;
+    }
 }
 
 template <typename FullEntity>
@@ -457,7 +772,9 @@ template <typename T>
 T & EntityBase<FullEntity>::ensure() {
     auto rv = ptr<T>();
     if (rv) return *rv;
-    return std::get<0>( as_fe().template add_<T>(TypeList<T>{}) );
+    auto & added = std::get<0>( as_fe().template add_<T>(TypeList<T>{}) );
+    as_fe().log_components_change_(ComponentChange::added, TypeList<T>{});
+    return added;
 }
 
 // outside of file
@@ -21,7 +21,11 @@ QMAKE_LFLAGS   += -std=c++17
 SOURCES += \
     ../unit-tests/main.cpp \
     ../unit-tests/AvlTreeEntity.cpp \
-    ../unit-tests/HashTableEntity.cpp
+    ../unit-tests/HashTableEntity.cpp \
+    ../unit-tests/SortedVectorEntity.cpp \
+    ../unit-tests/AdaptiveEntity.cpp \
+    ../unit-tests/StaticEntity.cpp \
+    ../unit-tests/HybridEntity.cpp
 
 HEADERS += ../unit-tests/shared.hpp \
     ../inc/ecs-rev3/SharedPtr.hpp
@@ -30,21 +34,33 @@ HEADERS += \
     \ # Library Interface
     ../inc/ariajanke/ecs3/AvlTreeEntity.hpp \
     ../inc/ariajanke/ecs3/EntityRef.hpp \
+    ../inc/ariajanke/ecs3/EntityBlueprint.hpp \
     ../inc/ariajanke/ecs3/HashTableEntity.hpp \
+    ../inc/ariajanke/ecs3/SortedVectorEntity.hpp \
+    ../inc/ariajanke/ecs3/AdaptiveEntity.hpp \
+    ../inc/ariajanke/ecs3/StaticEntity.hpp \
+    ../inc/ariajanke/ecs3/HybridEntity.hpp \
     ../inc/ariajanke/ecs3/defs.hpp \
     ../inc/ariajanke/ecs3/ecs.hpp \
     ../inc/ariajanke/ecs3/entity-common.hpp \
     ../inc/ariajanke/ecs3/Scene.hpp \
     ../inc/ariajanke/ecs3/FunctionTraits.hpp \
     ../inc/ariajanke/ecs3/SingleSystem.hpp \
+    ../inc/ariajanke/ecs3/BatchSystem.hpp \
     ../inc/ariajanke/ecs3/SharedPtr.hpp \
     \ # Library Private Headers
     ../inc/ariajanke/ecs3/detail/AvlTreeEntity.hpp \
     ../inc/ariajanke/ecs3/detail/HashTableEntity.hpp \
+    ../inc/ariajanke/ecs3/detail/SortedVectorEntity.hpp \
+    ../inc/ariajanke/ecs3/detail/AdaptiveEntity.hpp \
+    ../inc/ariajanke/ecs3/detail/StaticEntity.hpp \
+    ../inc/ariajanke/ecs3/detail/HybridEntity.hpp \
+    ../inc/ariajanke/ecs3/detail/Scene.hpp \
     ../inc/ariajanke/ecs3/detail/defs.hpp \
     ../inc/ariajanke/ecs3/detail/HashMap.hpp \
     ../inc/ariajanke/ecs3/detail/EntityRef.hpp \
-    ../inc/ariajanke/ecs3/detail/SingleSystem.hpp
+    ../inc/ariajanke/ecs3/detail/SingleSystem.hpp \
+    ../inc/ariajanke/ecs3/detail/BatchSystem.hpp
     
 INCLUDEPATH += \
     ../lib/cul/inc  \
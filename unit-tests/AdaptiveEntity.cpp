@@ -0,0 +1,116 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#include "shared.hpp"
+
+namespace {
+
+using Body = ecs::AdaptiveEntityBody;
+
+// past the threshold to move to a hash table
+static constexpr const int k_many = int(Body::k_to_table_count) + 4;
+
+template <int ... kt_ns>
+void remove_numbered_below
+    (ecs::AdaptiveEntity & e, int limit, std::integer_sequence<int, kt_ns...>)
+    { ((kt_ns < limit ? e.remove<Numbered<kt_ns>>() : void()), ...); }
+
+#define mark MACRO_MARK_POSITION_OF_CUL_TEST_SUITE
+
+} // end of <anonymous> namespace
+
+bool test_adaptiveentity() {
+    using namespace cul::ts;
+    using Seq = std::make_integer_sequence<int, k_many>;
+    TestSuite suite;
+    suite.start_series("adaptive entity layouts");
+    reset_all_counts();
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        e.add<A, B, C>();
+        return test(!e.uses_hash_table());
+    });
+    // every component survives the move to a hash table
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        return test(   e.uses_hash_table() && count_numbered(e, Seq{}) == k_many
+                    && NumberedCount::count() == k_many);
+    });
+    // dropping just below the threshold does not move components back
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        remove_numbered_below(e, k_many - int(Body::k_to_table_count), Seq{});
+        return test(   e.uses_hash_table()
+                    && count_numbered(e, Seq{}) == int(Body::k_to_table_count));
+    });
+    // ...dropping well below does, and every component survives that too
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        remove_numbered_below(e, k_many - int(Body::k_to_array_count) + 1, Seq{});
+        return test(   !e.uses_hash_table()
+                    && count_numbered(e, Seq{}) == int(Body::k_to_array_count) - 1);
+    });
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        auto c = e.clone_sceneless();
+        return test(c.uses_hash_table() && count_numbered(c, Seq{}) == k_many);
+    });
+    // an edit settles layout once, for the count it leaves
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        remove_numbered_below(e, k_many - int(Body::k_to_array_count), Seq{});
+        // adds bring the count back over, so the edit must not move
+        // components to the array on the way
+        auto gen = e.storage_generation();
+        (void)e.edit().remove<Numbered<k_many - 1>>().add<A>().add<B>().commit();
+        return test(   e.uses_hash_table() && e.has_all<A, B>()
+                    && e.storage_generation() - gen == 1);
+    });
+    // ...nor may its first add, when what it removes leaves few enough
+    // for the array, as that would move what earlier adds handed back
+    mark(suite).test([] {
+        auto e = ecs::AdaptiveEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        remove_numbered_below(e, k_many - int(Body::k_to_array_count), Seq{});
+        auto [a, b, c, d] = e.edit().
+            remove<Numbered<k_many - 1>>().remove<Numbered<k_many - 2>>().
+            add<A>().add<B>().add<C>().add<D>().commit();
+        d.m[0] = 7;
+        return test(   e.uses_hash_table() && &a == e.ptr<A>()
+                    && &b == e.ptr<B>() && &c == e.ptr<C>() && &d == e.ptr<D>()
+                    && e.get<D>().m[0] == 7);
+    });
+    mark(suite).test([] {
+        return test(NumberedCount::count() == 0);
+    });
+    return suite.has_successes_only();
+}
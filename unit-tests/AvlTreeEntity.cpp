@@ -71,6 +71,26 @@ AvlInsertRes insert_nodes
 template <typename T>
 T & rvalue_as_ref(T && obj) { return obj; }
 
+// checks cached heights against the real ones, as well as AVL balance
+int checked_height(const ecs::NodeInstance * node) {
+    if (!node) return 0;
+    auto lh = checked_height(node->left ());
+    auto rh = checked_height(node->right());
+    if (lh < 0 || rh < 0 || std::abs(lh - rh) > 1) return -1;
+    auto h = std::max(lh, rh) + 1;
+    return h == node->height() ? h : -1;
+}
+
+template <int ... kt_ns>
+std::array<ecs::NodeOwningPtr, sizeof...(kt_ns)>
+    make_numbered_nodes(std::integer_sequence<int, kt_ns...>)
+    { return { ecs::make_single_type_node<Numbered<kt_ns>>()... }; }
+
+template <int ... kt_ns>
+std::array<ecs::Size, sizeof...(kt_ns)>
+    numbered_keys(std::integer_sequence<int, kt_ns...>)
+    { return { ecs::MetaFunctions::key_for_type<Numbered<kt_ns>>()... }; }
+
 AvlInsertRes insert_nodes
     (std::initializer_list<ecs::NodeOwningPtr *> nodes, AvlInsertRes res = AvlInsertRes{})
 {
@@ -82,6 +102,10 @@ AvlInsertRes insert_nodes
     return res;
 }
 
+template <int ... kt_ns>
+void remove_odd_numbered(ecs::AvlTreeEntity & e, std::integer_sequence<int, kt_ns...>)
+    { ((kt_ns % 2 ? e.remove<Numbered<kt_ns>>() : void()), ...); }
+
 #define mark MACRO_MARK_POSITION_OF_CUL_TEST_SUITE
 
 } // end of <anonymous> namespace
@@ -223,6 +247,32 @@ bool test_avltreeentity() {
         } ();
         return test(preokay && AllInst::count() == 0);
     });
+    // many lone nodes, inserted and removed (including nodes with two
+    // children), must keep the tree AVL with correct heights
+    mark(suite).test([] {
+        using Seq = std::make_integer_sequence<int, 48>;
+        bool okay = true;
+        {
+        auto nodes = make_numbered_nodes(Seq{});
+        auto keys  = numbered_keys(Seq{});
+        NodeOwningPtr root;
+        for (auto & node : nodes) {
+            root = Ni::avl_insert(move(root), move(node)).root;
+            okay &= checked_height(root.get()) > 0;
+        }
+        for (std::size_t i = 0; i < keys.size(); i += 2) {
+            auto res = Ni::avl_remove(move(root), keys[i]);
+            okay &= !!res.removed && !res.removed->left() && !res.removed->right();
+            root = move(res.root);
+            okay &= checked_height(root.get()) > 0;
+        }
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            okay &= !!root->ptr_(keys[i]) == (i % 2 == 1);
+        }
+        okay &= NumberedCount::count() == 24;
+        }
+        return test(okay && NumberedCount::count() == 0);
+    });
     ecs::make_multiple_type_nodes<A, B, C, D, F>();
     mark(suite).test([] {
         // size 16 align 8
@@ -262,6 +312,233 @@ bool test_avltreeentity() {
         }
         return test(true);
     });
+    // freed nodes are pooled, and handed out to the next of a similar size
+    mark(suite).test([] {
+        // same size, and so the same size class
+        static_assert(sizeof(ecs::SingleNode<A>) == sizeof(ecs::SingleNode<B>));
+        auto a = ecs::make_single_type_node<A>();
+        auto * a_addr = static_cast<void *>(a.get());
+        a.reset();
+        auto b = ecs::make_single_type_node<B>();
+        return test(a_addr == static_cast<void *>(b.get()));
+    });
+    // the last component alive in a multi-type node is let go, rather than
+    // vacated, so that the whole node is freed
+    mark(suite).test([] {
+        bool okay;
+        {
+        auto nodes = ecs::make_multiple_type_nodes<A, B, C>();
+        okay = nodes[0]->vacate() && nodes[1]->vacate();
+        okay &= !nodes[2]->vacate() && AllInst::count() == 1;
+        }
+        return test(okay && AllInst::count() == 0);
+    });
+    // a removed component's space, in a multi-type node, is kept for the next
+    // component of the same type
+    mark(suite).test([] {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        auto * a_ptr = &std::get<A &>(e.add<A, B, C>());
+        e.remove<A>();
+        bool okay = Counted<A>::count() == 0 && !e.has<A>() && e.has_all<B, C>();
+        okay &= &e.add<A>() == a_ptr && Counted<A>::count() == 1;
+        e.remove<A, B>();
+        okay &= Counted<A>::count() == 0 && Counted<B>::count() == 0 && Counted<C>::count() == 1;
+        e.add<B>();
+        okay &= Counted<B>::count() == 1 && e.has_all<B, C>();
+        e.remove<B, C>();
+        return test(okay && Counted<B>::count() == 0 && Counted<C>::count() == 0);
+    });
+    // ...where a component is constructed just as it would be in a new node
+    mark(suite).test([] {
+        using Ints = std::vector<int>;
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        bool okay = e.add<Ints>(3, 5).size() == 3;
+        e.remove<Ints>();
+        e.add<A, Ints>();
+        e.remove<Ints>();
+        return test(okay && e.add<Ints>(3, 5).size() == 3);
+    });
+    // sorted nodes are built into a perfectly balanced tree, and joined with
+    // others without losing any
+    mark(suite).test([] {
+        using Seq = std::make_integer_sequence<int, 15>;
+        auto nodes = make_numbered_nodes(Seq{});
+        auto keys  = numbered_keys(Seq{});
+        auto by_key = [] (const NodeOwningPtr & lhs, const NodeOwningPtr & rhs)
+            { return lhs->key() < rhs->key(); };
+        std::sort(nodes.begin(), nodes.begin() + 10, by_key);
+        std::sort(nodes.begin() + 10, nodes.end(), by_key);
+        bool okay;
+        {
+        auto root = Ni::build_balanced(nodes.data(), nodes.data() + 10);
+        okay = checked_height(root.get()) == 4;
+        root = Ni::join_sorted(move(root), nodes.data() + 10, nodes.data() + 15);
+        okay &= checked_height(root.get()) == 4;
+        for (auto key : keys)
+            { okay &= !!root->ptr_(key); }
+        okay &= NumberedCount::count() == 15;
+        }
+        return test(okay && NumberedCount::count() == 0);
+    });
+    // a few nodes joined with a much larger tree are inserted on their own,
+    // rather than laying out the tree again
+    mark(suite).test([] {
+        using Seq = std::make_integer_sequence<int, 42>;
+        auto nodes = make_numbered_nodes(Seq{});
+        auto keys  = numbered_keys(Seq{});
+        auto by_key = [] (const NodeOwningPtr & lhs, const NodeOwningPtr & rhs)
+            { return lhs->key() < rhs->key(); };
+        std::sort(nodes.begin(), nodes.begin() + 40, by_key);
+        std::sort(nodes.begin() + 40, nodes.end(), by_key);
+        bool okay;
+        {
+        auto root = Ni::build_balanced(nodes.data(), nodes.data() + 40);
+        const auto * old_root = root.get();
+        root = Ni::join_sorted(move(root), nodes.data() + 40, nodes.data() + 42);
+        // rebuilding would have picked the middle of all 42 as the root
+        okay = root.get() == old_root && Ni::is_avl(root);
+        for (auto key : keys)
+            { okay &= !!root->ptr_(key); }
+        okay &= NumberedCount::count() == 42;
+        }
+        return test(okay && NumberedCount::count() == 0);
+    });
+    // datum and source are found by offsets, keeping nodes to four words
+    mark(suite).test([] {
+        return test(sizeof(Ni) <= 4*sizeof(void *));
+    });
+    // snapshots share every component, until one side changes it
+    mark(suite).test([] {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        e.add<A, B, D>();
+        e.get<D>().m[0] = 1;
+        auto s = e.snapshot();
+        // (non-constant access would copy)
+        bool okay =    AllInst::count() == 3
+                    && s.as_constant().ptr<A>() == e.as_constant().ptr<A>();
+        e.get<D>().m[0] = 2;
+        okay &= Counted<D>::count() == 2 && s.get<D>().m[0] == 1;
+        e.remove<B>();
+        okay &= !e.has<B>() && s.has<B>() && Counted<B>::count() == 1;
+        return test(okay);
+    });
+    reset_all_counts();
+    // ...even through a handle, which found it before the snapshot
+    mark(suite).test([] {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        e.add<D>().m[0] = 1;
+        auto h = e.handle<D>();
+        h.get().m[0] = 2;
+        auto s = e.snapshot();
+        h.get().m[0] = 99;
+        return test(e.get<D>().m[0] == 99 && s.get<D>().m[0] == 2);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        using Seq = std::make_integer_sequence<int, 15>;
+        bool okay;
+        {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        auto s = e.snapshot();
+        okay = NumberedCount::count() == 15;
+        remove_odd_numbered(e, Seq{});
+        okay &= count_numbered(e, Seq{}) == 8 && count_numbered(s, Seq{}) == 15;
+        e.add<A, B>();
+        okay &= count_numbered(s, Seq{}) == 15 && !s.has<A>() && e.has<A>();
+        // once the snapshot is gone, no further copies are made
+        s = ecs::AvlTreeEntity{};
+        auto count = NumberedCount::count();
+        e.get<Numbered<0>>();
+        okay &= count == NumberedCount::count();
+        }
+        return test(okay && NumberedCount::count() == 0 && AllInst::count() == 0);
+    });
+    reset_all_counts();
+    // adding several components, after a snapshot, copies only the paths
+    // they touch rather than every component
+    mark(suite).test([] {
+        using Seq = std::make_integer_sequence<int, 63>;
+        bool okay;
+        {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        add_numbered(e, Seq{});
+        auto s = e.snapshot();
+        e.add<A, B>();
+        okay =    NumberedCount::count() < 63 + 63 / 2
+               && count_numbered(e, Seq{}) == 63 && count_numbered(s, Seq{}) == 63
+               && e.has_all<A, B>() && !s.has_any<A, B>();
+        }
+        return test(okay && NumberedCount::count() == 0 && AllInst::count() == 0);
+    });
+    reset_all_counts();
+    // the least recently used entry is the one forgotten
+    mark(suite).test([] {
+        ecs::MruLookupCache cache;
+        int data[ecs::MruLookupCache::k_size + 1];
+        for (int i = 0; i != ecs::MruLookupCache::k_size; ++i)
+            { cache.remember(ecs::Size(i + 1), &data[i]); }
+        bool okay = cache.find(1) == &data[0];
+        cache.remember(ecs::MruLookupCache::k_size + 1, &data[ecs::MruLookupCache::k_size]);
+        return test(okay && cache.find(1) == &data[0] && !cache.find(2));
+    });
+    // removed components are not found through stale cache entries
+    mark(suite).test([] {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        e.add<A, B>();
+        bool okay = e.ptr<A>() && e.ptr<B>() && e.ptr<A>();
+        e.remove<A>();
+        okay &= !e.ptr<A>() && e.as_constant().ptr<B>() == e.ptr<B>();
+        e.add<A>();
+        return test(okay && e.ptr<A>() == &e.get<A>());
+    });
+    reset_all_counts();
+    // freezing moves components, and adding a component thaws them back
+    mark(suite).test([] {
+        bool okay;
+        {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        e.add<A, B, D>();
+        e.get<D>().m[0] = 3;
+        e.freeze();
+        okay =    e.is_frozen() && AllInst::count() == 3
+               && e.has_all<A, B, D>() && !e.has<C>() && e.get<D>().m[0] == 3;
+        e.add<C>();
+        okay &= !e.is_frozen() && e.has_all<A, B, C, D>() && e.get<D>().m[0] == 3;
+        }
+        return test(okay && AllInst::count() == 0);
+    });
+    reset_all_counts();
+    // a snapshot keeps its components when the original freezes
+    mark(suite).test([] {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        e.add<A, D>();
+        e.get<D>().m[0] = 5;
+        auto s = e.snapshot();
+        e.freeze();
+        e.remove<A>();
+        return test(   !e.has<A>() && e.get<D>().m[0] == 5
+                    && s.has<A>() && s.get<D>().m[0] == 5);
+    });
+    reset_all_counts();
+    // freezing copies only what's still shared, and moves the rest
+    mark(suite).test([] {
+        bool okay;
+        {
+        auto e = ecs::AvlTreeEntity::make_sceneless_entity();
+        e.add<A, B, D>();
+        e.get<D>().m[0] = 1;
+        auto s = e.snapshot();
+        e.get<D>().m[0] = 2;
+        e.freeze();
+        okay =    e.is_frozen() && e.get<D>().m[0] == 2 && s.get<D>().m[0] == 1
+               && e.has_all<A, B>() && s.has_all<A, B>()
+               && Counted<A>::count() == 2 && Counted<D>::count() == 2
+               && AllInst::count() == 6;
+        }
+        return test(okay && AllInst::count() == 0);
+    });
+    reset_all_counts();
     return suite.has_successes_only();
 }
 
@@ -103,6 +103,7 @@ bool test_hashtable() {
     using namespace cul::ts;
     TestSuite suite;
     using HetTable = ecs::HeterogeneousHashTable;
+    using Byte = std::byte;
     suite.start_series("heterogeneous typed hash table");
     reset_all_counts();
     mark(suite).test([] {
@@ -144,6 +145,28 @@ bool test_hashtable() {
         return test(d == gd);
     });
     reset_all_counts();
+    // an edit must size storage exactly once
+    mark(suite).test([] {
+        auto e = ecs::HashTableEntity::make_sceneless_entity();
+        e.add<A>();
+        auto gen = e.storage_generation();
+        (void)e.edit().remove<A>().add<B>().add<C>().add<D>().
+            add<E>(0.f, true, "").add<F>().commit();
+        // one for the remove, one for the reallocation
+        return test(e.storage_generation() - gen == 2);
+    });
+    reset_all_counts();
+    // blueprint components are found where the blueprint places them
+    mark(suite).test([] {
+        using Blueprint = ecs::EntityBlueprint<A, D, Trivial>;
+        HetTable tab;
+        auto [a, d, t] = tab.emplace_blueprint(Blueprint{});
+        auto * base = reinterpret_cast<Byte *>(&d) - Blueprint::offset_of<D>();
+        return test(   tab.get<A>() == &a && tab.get<D>() == &d
+                    && tab.get<Trivial>() == &t
+                    && reinterpret_cast<Byte *>(&t) == base + Blueprint::offset_of<Trivial>());
+    });
+    reset_all_counts();
     // must not double destruct!
     mark(suite).test([] {
         int a_count = [] {
@@ -156,6 +179,34 @@ bool test_hashtable() {
         return test(a_count == 0 && Counted<A>::count() == 0);
     });
     reset_all_counts();
+    // freezing moves components, and removing a component thaws them back
+    mark(suite).test([] {
+        bool okay;
+        {
+        auto e = ecs::HashTableEntity::make_sceneless_entity();
+        e.add<A, B, D>();
+        e.get<D>().m[0] = 3;
+        e.freeze();
+        okay =    e.is_frozen() && AllInst::count() == 3
+               && e.has_all<A, B, D>() && !e.has<C>() && e.get<D>().m[0] == 3;
+        e.remove<B>();
+        okay &=    !e.is_frozen() && e.has_all<A, D>() && !e.has<B>()
+                && e.get<D>().m[0] == 3 && AllInst::count() == 2;
+        }
+        return test(okay && AllInst::count() == 0);
+    });
+    reset_all_counts();
+    // a frozen entity clones like any other
+    mark(suite).test([] {
+        auto e = ecs::HashTableEntity::make_sceneless_entity();
+        e.add<A, D>();
+        e.get<D>().m[0] = 4;
+        e.freeze();
+        auto c = e.clone_sceneless();
+        return test(   c.is_frozen() && c.get<D>().m[0] == 4
+                    && AllInst::count() == 4);
+    });
+    reset_all_counts();
     return suite.has_successes_only();
 }
 
@@ -0,0 +1,73 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#include "shared.hpp"
+
+namespace {
+
+using Hybrid = ecs::HybridEntity<A, B>;
+
+#define mark MACRO_MARK_POSITION_OF_CUL_TEST_SUITE
+
+} // end of <anonymous> namespace
+
+bool test_hybridentity() {
+    using namespace cul::ts;
+    TestSuite suite;
+    suite.start_series("hybrid entity");
+    reset_all_counts();
+    // hot components never reach the table
+    mark(suite).test([] {
+        auto e = Hybrid::make_sceneless_entity();
+        e.add<A, B>();
+        bool okay = e.capacity_used().component_count == 0;
+        e.add<D, F>();
+        return test(   okay && e.capacity_used().component_count == 2
+                    && e.has_all<A, B, D, F>() && AllInst::count() == 4);
+    });
+    reset_all_counts();
+    // hot components stay put, while the table grows around them
+    mark(suite).test([] {
+        auto e = Hybrid::make_sceneless_entity();
+        auto * a = &e.add<A>();
+        auto gen = e.storage_generation();
+        e.add<C>();
+        e.add<D>();
+        e.add<E>(0.f, true, "");
+        e.add<F>();
+        return test(e.ptr<A>() == a && e.storage_generation() != gen);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        auto e = Hybrid::make_sceneless_entity();
+        e.add<A, C>();
+        e.remove<A, C>();
+        return test(!e.has_any<A, C>() && AllInst::count() == 0);
+    });
+    reset_all_counts();
+    return suite.has_successes_only();
+}
@@ -0,0 +1,130 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#include "shared.hpp"
+
+namespace {
+
+// well over the linear search limit, so that binary search is also covered
+static constexpr const int k_many = 40;
+
+template <int ... kt_ns>
+void append_numbered
+    (ecs::SortedComponentArray & arr, std::integer_sequence<int, kt_ns...>)
+    { (arr.append<Numbered<kt_ns>>(), ...); }
+
+template <int ... kt_ns>
+void remove_odd_numbered
+    (ecs::SortedComponentArray & arr, std::integer_sequence<int, kt_ns...>)
+    { ((kt_ns % 2 ? (void)arr.remove<Numbered<kt_ns>>() : void()), ...); }
+
+// @returns number of components found, with the expected value, at the
+//          expected parity
+template <int ... kt_ns>
+int count_numbered
+    (const ecs::SortedComponentArray & arr, std::integer_sequence<int, kt_ns...>,
+     bool odds_present = true)
+{
+    auto found = [&arr, odds_present] (const auto * ptr, int n) {
+        if (!odds_present && n % 2) return ptr ? -k_many : 0;
+        return ptr && ptr->value == n ? 1 : 0;
+    };
+    return (found(arr.get<Numbered<kt_ns>>(), kt_ns) + ...);
+}
+
+bool keys_are_sorted(const ecs::SortedComponentArray & arr) {
+    bool rv = true;
+    ecs::Size last = 0;
+    arr.for_each([&rv, &last] (ecs::Size key, void *, const ecs::MetaFunctions &) {
+        rv &= last < key;
+        last = key;
+    });
+    return rv;
+}
+
+#define mark MACRO_MARK_POSITION_OF_CUL_TEST_SUITE
+
+} // end of <anonymous> namespace
+
+bool test_sortedvectorentity() {
+    using namespace cul::ts;
+    using SortedArray = ecs::SortedComponentArray;
+    using Seq = std::make_integer_sequence<int, k_many>;
+    TestSuite suite;
+    suite.start_series("sorted component array");
+    reset_all_counts();
+    mark(suite).test([] {
+        int fc = [] {
+            SortedArray arr;
+            (void)arr.append<A>();
+            return Counted<A>::count();
+        } ();
+        return test(fc == 1 && Counted<A>::count() == 0);
+    });
+    mark(suite).test([] {
+        SortedArray arr;
+        (void)arr.append<A>();
+        return test(should_throw<RtError>([&arr] { arr.append<A>(); }));
+    });
+    // every component survives moving to larger allocations
+    mark(suite).test([] {
+        SortedArray arr;
+        append_numbered(arr, Seq{});
+        return test(   count_numbered(arr, Seq{}) == k_many
+                    && keys_are_sorted(arr) && arr.size() == k_many);
+    });
+    mark(suite).test([] {
+        SortedArray arr;
+        append_numbered(arr, Seq{});
+        remove_odd_numbered(arr, Seq{});
+        return test(   count_numbered(arr, Seq{}, false) == k_many / 2
+                    && keys_are_sorted(arr) && arr.size() == k_many / 2);
+    });
+    mark(suite).test([] {
+        SortedArray arr;
+        append_numbered(arr, Seq{});
+        SortedArray copy;
+        copy.copy_from(arr);
+        bool okay = count_numbered(copy, Seq{}) == k_many;
+        arr.remove_all();
+        return test(   okay && count_numbered(copy, Seq{}) == k_many
+                    && arr.size() == 0 && !arr.get<Numbered<0>>());
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        SortedArray arr;
+        arr.reserve_for_more(TypeList<A, B, C>{});
+        auto * a = &arr.append<A>();
+        (void)arr.append<B>();
+        (void)arr.append<C>();
+        // reservation should have kept the first from moving
+        bool okay = a == arr.get<A>() && AllInst::count() == 3;
+        arr.remove_all();
+        return test(okay && AllInst::count() == 0);
+    });
+    return suite.has_successes_only();
+}
@@ -0,0 +1,113 @@
+/****************************************************************************
+
+    MIT License
+
+    Copyright (c) 2022 Aria Janke
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*****************************************************************************/
+
+
+#include "shared.hpp"
+
+namespace {
+
+using Static = ecs::StaticEntity<A, B, C, E>;
+
+#define mark MACRO_MARK_POSITION_OF_CUL_TEST_SUITE
+
+} // end of <anonymous> namespace
+
+bool test_staticentity() {
+    using namespace cul::ts;
+    TestSuite suite;
+    suite.start_series("static entity");
+    reset_all_counts();
+    mark(suite).test([] {
+        auto e = Static::make_sceneless_entity();
+        e.add<A, B>();
+        e.add<E>(0.f, true, "");
+        return test(   e.has_all<A, B, E>() && !e.has<C>() && !e.ptr<D>()
+                    && AllInst::count() == 3);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        auto e = Static::make_sceneless_entity();
+        e.add<A>();
+        return test(should_throw<RtError>([&e] { e.add<A>(); }));
+    });
+    reset_all_counts();
+    // slots never move, so only removal advances the generation
+    mark(suite).test([] {
+        auto e = Static::make_sceneless_entity();
+        auto * a = &e.add<A>();
+        auto gen = e.storage_generation();
+        e.add<B, C>();
+        bool okay = e.storage_generation() == gen && e.ptr<A>() == a;
+        e.remove<B>();
+        return test(   okay && e.storage_generation() != gen
+                    && !e.has<B>() && Counted<B>::count() == 0);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        {
+        auto e = Static::make_sceneless_entity();
+        e.add<A, B, C>();
+        }
+        return test(AllInst::count() == 0);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        auto e = Static::make_sceneless_entity();
+        e.add<A, B>();
+        auto c = e.clone_sceneless();
+        return test(c.has_all<A, B>() && AllInst::count() == 4);
+    });
+    reset_all_counts();
+    // C is not copyable, and nothing is left behind
+    mark(suite).test([] {
+        auto e = Static::make_sceneless_entity();
+        e.add<A, B, C>();
+        return test(   should_throw<RtError>([&e] { (void)e.clone_sceneless(); })
+                    && AllInst::count() == 3);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        auto e = Static::make_sceneless_entity();
+        e.add<A>();
+        Static r{e.as_reference()};
+        return test(r == e && r.has<A>());
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        ecs::SceneOf<Static> scene;
+        scene.make_entity().add<A>();
+        scene.make_entity().add<A, B>();
+        scene.update_entities();
+        int with_a = 0, with_b = 0;
+        auto system = ecs::make_singles_system<Static>(
+            [&with_a] (A &) { ++with_a; },
+            [&with_b] (A &, B &, ecs::Optional<D>) { ++with_b; });
+        system(scene);
+        return test(with_a == 2 && with_b == 1);
+    });
+    reset_all_counts();
+    return suite.has_successes_only();
+}
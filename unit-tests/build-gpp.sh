@@ -1,5 +1,5 @@
 #!/bin/bash
-sources="main.cpp HashTableEntity.cpp AvlTreeEntity.cpp"
+sources="main.cpp HashTableEntity.cpp AvlTreeEntity.cpp SortedVectorEntity.cpp AdaptiveEntity.cpp StaticEntity.cpp HybridEntity.cpp"
 includes="-I../lib/cul/inc -I../inc"
 enablecoverage="-fprofile-instr-generate -fcoverage-mapping"
 defaultflags="-std=c++17 -Wno-unqualified-std-cast-call -O3 -Wall -pedantic-errors -DMACRO_PLATFORM_LINUX -DMACRO_ARIAJANKE_ECS3_ENABLE_TYPESET_TESTS -fexceptions"
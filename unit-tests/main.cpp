@@ -33,6 +33,15 @@ const char * k_name_for_entity_tests<ecs::HashTableEntity> = "HashTableEntity";
 template <>
 const char * k_name_for_entity_tests<ecs::AvlTreeEntity> = "AvlTreeEntity";
 
+template <>
+const char * k_name_for_entity_tests<ecs::SortedVectorEntity> = "SortedVectorEntity";
+
+template <>
+const char * k_name_for_entity_tests<ecs::AdaptiveEntity> = "AdaptiveEntity";
+
+template <>
+const char * k_name_for_entity_tests<ecs::HybridEntity<A, B>> = "HybridEntity<A, B>";
+
 static constexpr const int k_dog_noises = 1;
 static constexpr const int k_cat_noises = 2;
 
@@ -213,9 +222,16 @@ int main() {
     return andf(
         run_tests_for_entity_type<HashTableEntity>(),
         run_tests_for_entity_type<AvlTreeEntity>(),
+        run_tests_for_entity_type<SortedVectorEntity>(),
+        run_tests_for_entity_type<AdaptiveEntity>(),
+        run_tests_for_entity_type<HybridEntity<A, B>>(),
         test_sharedptr(),
         test_hashtableentity(),
-        test_avltreeentity()
+        test_avltreeentity(),
+        test_sortedvectorentity(),
+        test_adaptiveentity(),
+        test_staticentity(),
+        test_hybridentity()
                 ) ? 0 : ~0;
 }
 
@@ -97,6 +97,35 @@ struct E final : public Counted<E>, public AllInst {
     E(float, bool, const char *) {}
 };
 struct F final : public Counted<F>, public AllInst {};
+// trivially copyable, and uncounted
+struct Trivial final { double value = 0.; };
+// still trivially copyable, but only movable
+struct MoveOnlyTrivial final {
+    MoveOnlyTrivial() {}
+    MoveOnlyTrivial(const MoveOnlyTrivial &) = delete;
+    MoveOnlyTrivial(MoveOnlyTrivial &&) = default;
+    int value = 0;
+};
+
+// as many distinct component types as a test needs, each knowing its own
+// number, and all counted together
+template <int k_n>
+struct Numbered final : public Counted<Numbered<0>> { int value = k_n; };
+
+using NumberedCount = Counted<Numbered<0>>;
+
+template <typename EntityType, int ... kt_ns>
+void add_numbered(EntityType & e, std::integer_sequence<int, kt_ns...>)
+    { (e.template add<Numbered<kt_ns>>(), ...); }
+
+// @returns number of components found, with the expected value
+template <typename EntityType, int ... kt_ns>
+int count_numbered(const EntityType & e, std::integer_sequence<int, kt_ns...>) {
+    auto found = [] (const auto * ptr, int n)
+        { return ptr && ptr->value == n ? 1 : 0; };
+    auto ce = e.as_constant();
+    return (found(ce.template ptr<Numbered<kt_ns>>(), kt_ns) + ...);
+}
 
 template <typename ... Types>
 void reset_counts_on_(TypeList<Types...>)
@@ -206,6 +235,14 @@ bool test_hashtableentity();
 
 bool test_avltreeentity();
 
+bool test_sortedvectorentity();
+
+bool test_adaptiveentity();
+
+bool test_staticentity();
+
+bool test_hybridentity();
+
 template <typename ExcpType, typename F>
 bool should_throw(F && f) {
     try {
@@ -216,6 +253,14 @@ bool should_throw(F && f) {
     return false;
 }
 
+// not every entity type may remove all of its components at once
+template <typename T, typename = void>
+struct HasRemoveAll : std::false_type {};
+
+template <typename T>
+struct HasRemoveAll<T, std::void_t<decltype(std::declval<T &>().remove_all())>> :
+    std::true_type {};
+
 template <typename ... Types>
 bool andf(Types && ...) { return true; }
 
@@ -420,6 +465,14 @@ bool test_interface() {
         return test( cobj.template has_all<A, C>() );
     });
 
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<C>();
+        return test(   e.template has_any<A, B, C>()
+                    && !e.template has_any<A, B, D>());
+    });
+    reset_all_counts();
+
     // --- ptr ---
 
     mark(suite).test([] {
@@ -495,6 +548,233 @@ bool test_interface() {
                     && old_a_count == 1);
     });
 
+    // --- edit ---
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, C>();
+        auto [b, ee] = e.edit().
+            template remove<C>().
+            template add<B>().
+            template add<E>(2.f, false, "edit").
+            commit();
+        return test(   &b == e.template ptr<B>() && &ee == e.template ptr<E>()
+                    && !e.template has<C>() && e.template has<A>()
+                    && Counted<C>::count() == 0 && AllInst::count() == 3);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // components may be replaced in one edit
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<C>().mem = "old";
+        auto [c] = e.edit().template remove<C>().template add<C>().commit();
+        return test(c.mem == C::k_message && Counted<C>::count() == 1);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // nothing changes on a bad edit
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B>();
+        bool threw = should_throw<std::runtime_error>([&e] {
+            (void)e.edit().template remove<A>().template add<B>().commit();
+        });
+        return test(threw && e.template has_all<A, B>() && AllInst::count() == 2);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A>();
+        bool threw = should_throw<std::runtime_error>([&e] {
+            (void)e.edit().template remove<A, B>().commit();
+        });
+        return test(threw && e.template has<A>());
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // an edit need not add anything
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B>();
+        (void)e.edit().template remove<A>().commit();
+        return test(!e.template has<A>() && e.template has<B>() && AllInst::count() == 1);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // an edit logs what it removed, then what it added, leaving out
+        // either if it names no types
+        using ecs::ComponentChange, ecs::Size;
+        using Record = Tuple<ComponentChange, Size>;
+        class Recorder final : public ecs::HomeSceneBase<EntityType> {
+        public:
+            Recorder() { this->start_logging_changes(); }
+
+            void on_create(const EntityType &) final {}
+
+            void on_deletion_request(const EntityType &) final {}
+
+            std::vector<Record> records() const {
+                std::vector<Record> rv;
+                this->change_log().for_each([&rv]
+                    (const EntityType &, ComponentChange change,
+                     const Size * keys_beg, const Size * keys_end)
+                { rv.emplace_back(change, Size(keys_end - keys_beg)); });
+                return rv;
+            }
+        };
+        Recorder recorder;
+        auto e = EntityType::make_sceneless_entity();
+        e.set_home_scene(recorder);
+        (void)e.edit().template add<A>().template add<B>().commit();
+        (void)e.edit().template remove<A>().template add<C>().commit();
+        (void)e.edit().template remove<B>().commit();
+        std::vector<Record> expected = {
+            Record{ComponentChange::added  , 2},
+            Record{ComponentChange::removed, 1},
+            Record{ComponentChange::added  , 1},
+            Record{ComponentChange::removed, 1}
+        };
+        if constexpr (HasRemoveAll<EntityType>::value) {
+            e.remove_all();
+            expected.emplace_back(ComponentChange::removed_all, 0);
+        }
+        return test(recorder.records() == expected);
+    });
+    reset_all_counts();
+
+    // --- clone ---
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B, D>();
+        e.template get<D>().m[10] = 42;
+        auto f = e.clone();
+        f.template get<D>().m[10] = 24;
+        return test(   f.template has_all<A, B, D>() && AllInst::count() == 6
+                    && e.template get<D>().m[10] == 42);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // space lost to removed components is no trouble
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B, D>();
+        e.template remove<B>();
+        e.template add<F>();
+        auto f = e.clone_sceneless();
+        return test(   f.template has_all<A, D, F>() && !f.template has<B>()
+                    && f.template ptr<D>() != e.template ptr<D>());
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // C cannot be copied
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B, C>();
+        bool threw = should_throw<std::runtime_error>([&e] { (void)e.clone(); });
+        return test(threw && AllInst::count() == 3);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        // a deleted copy constructor is respected, even if memcpy would do
+        static_assert(std::is_trivially_copyable_v<MoveOnlyTrivial>);
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, MoveOnlyTrivial>();
+        return test(should_throw<std::runtime_error>
+            ([&e] { (void)e.clone_sceneless(); }));
+    });
+    reset_all_counts();
+
+    // --- blueprints ---
+
+    mark(suite).test([] {
+        using Blueprint = ecs::EntityBlueprint<A, D, Trivial>;
+        static_assert(Blueprint::k_component_bytes >= sizeof(A) + sizeof(D) + sizeof(Trivial));
+        auto e = EntityType::make_sceneless_entity();
+        auto [a, d, t] = e.add(Blueprint{});
+        d.m[99] = 7;
+        t.value = 3.;
+        return test(   &a == e.template ptr<A>() && e.template get<D>().m[99] == 7
+                    && e.template get<Trivial>().value == 3. && AllInst::count() == 2);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<B>();
+        e.add(ecs::EntityBlueprint<A, C>{});
+        return test(e.template has_all<A, B, C>() && AllInst::count() == 3);
+    });
+    reset_all_counts();
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<C>();
+        bool threw = should_throw<std::runtime_error>([&e]
+            { e.add(ecs::EntityBlueprint<A, B, C>{}); });
+        return test(threw && AllInst::count() == 1);
+    });
+    reset_all_counts();
+
+    // --- handle ---
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B, C>();
+        auto h = e.template handle<C>();
+        return test(h.ptr() == e.template ptr<C>() && h.get().mem == C::k_message);
+    });
+
+    mark(suite).test([] {
+        // handle follows the component when storage is rearranged
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B>();
+        auto h = e.template handle<B>();
+        (void)h.ptr();
+        e.template add<D>();
+        e.template add<E>(1.f, false, "world");
+        e.template remove<A>();
+        return test(h.ptr() == e.template ptr<B>());
+    });
+
+    mark(suite).test([] {
+        // handle reports removed components
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A, B>();
+        auto h = e.template handle<B>();
+        bool had_b = h.ptr();
+        e.template remove<B>();
+        return test(had_b && !h.ptr());
+    });
+
+    mark(suite).test([] {
+        // handle finds components added after a miss
+        auto e = EntityType::make_sceneless_entity();
+        auto h = e.template handle<A>();
+        bool had_a = h.ptr();
+        e.template add<A>();
+        return test(!had_a && h.ptr() == e.template ptr<A>());
+    });
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        auto h = e.template handle<A>();
+        return test(should_throw<std::runtime_error>([&h] { (void)h.get(); }));
+    });
+
+    mark(suite).test([] {
+        auto e = EntityType::make_sceneless_entity();
+        e.template add<A>();
+        auto gen = e.storage_generation();
+        e.template remove<A>();
+        return test(gen != e.storage_generation());
+    });
+    reset_all_counts();
+
     // --- utilities ---
     mark(suite).test([] {
         // inequality
@@ -590,6 +870,344 @@ bool test_scene() {
         scene.update_entities();
         return test(scene.count() == 1);
     });
+    mark(suite).test([] {
+        // removals leave every other entity where the scene can find it
+        Scene scene;
+        std::vector<EntityType> ents;
+        for (int i = 0; i != 6; ++i) {
+            ents.push_back(scene.make_entity());
+            ents.back().template add<D>().m[0] = i;
+        }
+        ents[1].request_deletion();
+        ents[5].request_deletion();
+        ents[1].request_deletion();
+        scene.update_entities();
+        ents[3].request_deletion();
+        scene.update_entities();
+        int sum = 0;
+        for (auto & ent : scene) sum += ent.template get<D>().m[0];
+        return test(scene.count() == 3 && sum == 0 + 2 + 4);
+    });
+    mark(suite).test([] {
+        // scenes keep entities in the order they were created
+        Scene scene;
+        auto early = EntityType::make_sceneless_entity();
+        std::vector<EntityType> ents;
+        for (int i = 0; i != 4; ++i) ents.push_back(EntityType::make_sceneless_entity());
+        scene.add_entities(std::vector<EntityType>{ ents[2], ents[0], ents[3] });
+        auto e = scene.make_entity();
+        auto f = e.make_entity();
+        scene.add_entity(ents[1]);
+        scene.add_entity(early);
+        ents[3].request_deletion();
+        scene.update_entities();
+        std::vector<EntityType> expected{ early, ents[0], ents[1], ents[2], e, f };
+        return test(   early.id() < ents[0].id() && f.id() > e.id()
+                    && std::equal(scene.begin(), scene.end(),
+                                  expected.begin(), expected.end()));
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // systems visit only entities from the index of a required component
+        Scene scene;
+        scene.template track_component<A>();
+        std::vector<EntityType> ents;
+        for (int i = 0; i != 10; ++i) {
+            ents.push_back(scene.make_entity());
+            ents.back().template add<B>();
+        }
+        for (int i : { 2, 4, 6 }) ents[i].template add<A>();
+        scene.update_entities();
+        int visits = 0;
+        auto system = ecs::make_singles_system<EntityType>(
+            [&visits] (A &, B &) { ++visits; });
+        system(scene);
+        bool okay =    visits == 3
+                    && scene.template candidates_having<A, B>().end()
+                     - scene.template candidates_having<A, B>().begin() == 3
+                    && scene.template population_of<A>() == 3
+                    && scene.template population_of<B>() == 10;
+
+        ents[2].template remove<A>();
+        ents[4].request_deletion();
+        ents[5].template add<A>();
+        // changes within one update, only the last of them counts
+        ents[7].template add<A>();
+        ents[7].template remove<A>();
+        scene.update_entities();
+        visits = 0;
+        system(scene);
+        auto with_a = scene.template candidates_having<A>();
+        okay &=    visits == 2 && with_a.end() - with_a.begin() == 2
+                && std::all_of(with_a.begin(), with_a.end(), [] (const EntityType & ent)
+                               { return ent.template has<A>(); });
+        return test(okay);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // tracked types are looked up rarest first, then untracked ones, and
+        // lastly the type whose index is visited
+        using ecs::MetaFunctions;
+        Scene scene;
+        scene.template track_component<A>();
+        scene.template track_component<B>();
+        std::vector<EntityType> ents;
+        for (int i = 0; i != 10; ++i) {
+            ents.push_back(scene.make_entity());
+            ents.back().template add<B, C>();
+        }
+        for (int i : { 1, 5, 8 }) ents[i].template add<A>();
+        ents[0].template add<A>();
+        ents[0].template remove<B>();
+        scene.update_entities();
+        int visits = 0;
+        auto system = ecs::make_singles_system<EntityType>(
+            [&visits] (A &, B &, C &) { ++visits; });
+        system(scene);
+        std::vector<ecs::Size> expected = {
+            MetaFunctions::key_for_type<B>(), MetaFunctions::key_for_type<C>(),
+            MetaFunctions::key_for_type<A>()
+        };
+        return test(visits == 3 && system.probe_order(scene) == expected);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // views are cached, and kept current over updates
+        using ecs::Optional;
+        Scene scene;
+        std::vector<EntityType> ents;
+        for (int i = 0; i != 6; ++i) {
+            ents.push_back(scene.make_entity());
+            ents.back().template add<D>().m[0] = i;
+        }
+        for (int i : { 1, 3, 5 }) ents[i].template add<B>();
+        scene.update_entities();
+        auto & view = scene.template view<D, const B, Optional<A>>();
+        auto sum_of_d = [&view] {
+            int sum = 0;
+            view.for_each([&sum] (EntityType &, D & d, const B &, Optional<A>)
+                { sum += d.m[0]; });
+            return sum;
+        };
+        bool okay =    &view == &scene.template view<D, const B, Optional<A>>()
+                    && view.count() == 3 && sum_of_d() == 1 + 3 + 5;
+
+        ents[1].template remove<B>();
+        ents[3].request_deletion();
+        ents[4].template add<B>();
+        auto f = ents[0].make_entity();
+        std::get<0>(f.template add<D, B>()).m[0] = 10;
+        scene.update_entities();
+        okay &= view.count() == 3 && sum_of_d() == 4 + 5 + 10;
+        return test(okay);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // components found by a view follow their entity's storage around
+        using ecs::Optional;
+        Scene scene;
+        auto e = scene.make_entity();
+        e.template add<D>().m[0] = 7;
+        scene.update_entities();
+        auto & view = scene.template view<D, Optional<A>>();
+        e.template add<A, B, C>();
+        e.template add<E>(1.f, false, "");
+        int seen = 0;
+        bool has_a = false;
+        view.for_each([&] (EntityType &, D & d, Optional<A> a) {
+            seen += d.m[0];
+            has_a = !!a;
+        });
+        return test(seen == 7 && has_a);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // filters narrow which entities each functor sees
+        using ecs::Without, ecs::AnyOf;
+        Scene scene;
+        scene.make_entity().template add<A>();
+        scene.make_entity().template add<A, B>();
+        scene.make_entity().template add<A, C>();
+        scene.make_entity().template add<B, C>();
+        scene.make_entity().template add<D>();
+        scene.update_entities();
+        int without_b = 0, any_of_bc = 0, a_without_c = 0;
+        auto system = ecs::make_singles_system<EntityType>(
+            [&without_b] (Without<B>) { ++without_b; },
+            [&any_of_bc] (AnyOf<B, C>) { ++any_of_bc; },
+            [&a_without_c] (A &, Without<C>) { ++a_without_c; });
+        system(scene);
+        return test(without_b == 3 && any_of_bc == 3 && a_without_c == 2);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // running a system directly visits just as calling it does
+        Scene scene;
+        for (int i = 0; i != 5; ++i) {
+            auto e = scene.make_entity();
+            e.template add<A>();
+            if (i % 2) e.template add<B>();
+        }
+        scene.update_entities();
+        int a_count = 0, ab_count = 0;
+        auto system = ecs::make_singles_system<EntityType>(
+            [&a_count] (A &) { ++a_count; },
+            [&ab_count] (A &, B &) { ++ab_count; });
+        ecs::run(scene, system);
+        bool okay = a_count == 5 && ab_count == 2;
+        const ecs::SingleSystemBase<EntityType> & erased = system;
+        ecs::run(scene, erased);
+        return test(okay && a_count == 10 && ab_count == 4);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // a system with no run_on of its own is run through its base
+        class Visitor final : public ecs::SingleSystemBase<EntityType> {
+        public:
+            explicit Visitor(int & count_): m_count(count_) {}
+
+        private:
+            void operate(EntityType &) const final { ++m_count; }
+
+            int & m_count;
+        };
+        Scene scene;
+        for (int i = 0; i != 3; ++i) scene.make_entity();
+        scene.update_entities();
+        int count = 0;
+        Visitor visitor{count};
+        ecs::run(scene, visitor);
+        return test(count == 3);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // batch kernels see spans of matching entities, and what they write
+        // ends up with those entities
+        using ecs::Span;
+        int calls = 0, seen = 0;
+        auto system = ecs::make_batch_system<EntityType>(
+            [&calls, &seen] (Span<D> ds, Span<const B> bs) {
+                ++calls;
+                seen += int(bs.size());
+                for (auto & d : ds) d.m[0] *= 2;
+            });
+        // every other entity matches, leaving a partial batch at the end
+        static constexpr const int k_count = decltype(system)::k_batch_size*2 + 10;
+        Scene scene;
+        std::vector<EntityType> ents;
+        for (int i = 0; i != k_count; ++i) {
+            ents.push_back(scene.make_entity());
+            ents.back().template add<D>().m[0] = i;
+            if (i % 2 == 0) ents.back().template add<B>();
+        }
+        scene.update_entities();
+        ecs::run(scene, system);
+        bool okay = calls == 2 && seen == k_count / 2;
+        for (int i = 0; i != k_count; ++i)
+            { okay &= ents[i].template get<D>().m[0] == (i % 2 == 0 ? i*2 : i); }
+        return test(okay);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // a throwing kernel leaves nothing behind for the next run
+        using ecs::Span;
+        struct KernelError final {};
+        bool should_throw = true;
+        int seen = 0;
+        auto system = ecs::make_batch_system<EntityType>(
+            [&should_throw, &seen] (Span<D> ds) {
+                if (should_throw) throw KernelError{};
+                seen += int(ds.size());
+                for (auto & d : ds) d.m[0] *= 2;
+            });
+        static constexpr const int k_count = decltype(system)::k_batch_size + 10;
+        Scene scene;
+        std::vector<EntityType> ents;
+        for (int i = 0; i != k_count; ++i) {
+            ents.push_back(scene.make_entity());
+            ents.back().template add<D>().m[0] = i;
+        }
+        scene.update_entities();
+        bool threw = false;
+        try {
+            ecs::run(scene, system);
+        } catch (KernelError &) {
+            threw = true;
+        }
+        bool okay = threw;
+        for (int i = 0; i != k_count; ++i)
+            { okay &= ents[i].template get<D>().m[0] == i; }
+        should_throw = false;
+        ecs::run(scene, system);
+        okay &= seen == k_count;
+        for (int i = 0; i != k_count; ++i)
+            { okay &= ents[i].template get<D>().m[0] == i*2; }
+        return test(okay);
+    });
+    mark(suite).test([] {
+        // untracked types leave a system with every entity
+        Scene scene;
+        scene.template track_component<A>();
+        (void)scene.make_entity();
+        scene.make_entity().template add<B>();
+        scene.update_entities();
+        auto view = scene.template candidates_having<B>();
+        return test(view.end() - view.begin() == 2);
+    });
+    mark(suite).test([] {
+        // an entity is no longer a member once its scene is cleared
+        Scene scene;
+        auto e = scene.make_entity();
+        scene.clear();
+        return test(should_throw<std::invalid_argument>([&e] { e.request_deletion(); }));
+    });
+    mark(suite).test([] {
+        Scene scene;
+        auto proto = EntityType::make_sceneless_entity();
+        proto.template add<A, B>();
+        auto e = scene.instantiate(proto);
+        e.make_entity();
+        scene.update_entities();
+        return test(scene.count() == 2 && e.template has_all<A, B>());
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        Scene scene;
+        int i = 0;
+        scene.template spawn<ecs::EntityBlueprint<A, D>>(
+            10, [&i](EntityType & ent, A &, D & d) {
+                d.m[0] = i++;
+                ent.template add<B>();
+            });
+        scene.update_entities();
+        int sum = 0;
+        for (auto & ent : scene) {
+            if (ent.template has_all<A, B, D>()) sum += ent.template get<D>().m[0];
+        }
+        return test(scene.count() == 10 && sum == 45 && AllInst::count() == 30);
+    });
+    reset_all_counts();
+    mark(suite).test([] {
+        // scene learns how large its entities become
+        Scene scene;
+        auto e = scene.make_entity();
+        for (int i = 0; i != 4; ++i) {
+            auto f = e.make_entity();
+            f.template add<A, B, C>();
+            f.template add<D>();
+            f.template add<E>(1.f, true, "hello");
+        }
+        scene.update_entities();
+        auto f = e.make_entity();
+        auto gen = f.storage_generation();
+        f.template add<A>();
+        f.template add<B>();
+        f.template add<C>();
+        f.template add<D>();
+        f.template add<E>(1.f, true, "hello");
+        return test(gen == f.storage_generation());
+    });
+    reset_all_counts();
     return suite.has_successes_only();
 }
 